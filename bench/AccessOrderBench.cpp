@@ -0,0 +1,201 @@
+//
+// AccessOrderBench.cpp
+// Compares the seek pattern and wall time of stat'ing and reading a file set in container, inode and
+// physical order
+//
+// Usage: AccessOrderBench [directory]
+// Without a directory, a synthetic tree of small files is created in the temp directory and removed
+// afterwards. The page cache is dropped for every file before each read pass (posix_fadvise DONTNEED),
+// so the timings reflect the device; the seek figures come from FIEMAP and hold for any device.
+// The stat passes need cold dentry and inode caches, which only root can get (drop_caches); otherwise
+// they are reported as warm.
+//
+
+#include "FileEntryContainer.h"
+#include "FileScanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kSyntheticDirectories = 16;
+constexpr size_t kSyntheticFilesPerDirectory = 256;
+
+struct SeekProfile {
+    uint64_t distance = 0;   // Sum of the gaps between the end of one file and the start of the next
+    size_t backward = 0;     // Number of times the head has to move back
+    size_t unknown = 0;      // Files without a physical location
+};
+
+void createSyntheticTree(const fs::path& root) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<size_t> sizes(1024, 64 * 1024);
+
+    // Files are written in shuffled order, so directory, inode and block order all differ
+    std::vector<fs::path> paths;
+    for (size_t d = 0; d < kSyntheticDirectories; ++d) {
+        const auto directory = root / ("dir" + std::to_string(d));
+        fs::create_directories(directory);
+        for (size_t f = 0; f < kSyntheticFilesPerDirectory; ++f) {
+            paths.push_back(directory / ("file" + std::to_string(f) + ".dat"));
+        }
+    }
+    std::shuffle(paths.begin(), paths.end(), random);
+
+    for (const auto& path : paths) {
+        std::ofstream out(path, std::ios::binary);
+        const std::string data(sizes(random), 'x');
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+}
+
+// Drops the dentry and inode caches and the page cache, including the cached inode tables; Linux, root only
+bool dropMetadataCache() {
+#ifdef __linux__
+    ::sync();
+    std::ofstream control("/proc/sys/vm/drop_caches");
+    control << "3" << std::flush;
+    return static_cast<bool>(control);
+#else
+    return false;
+#endif
+}
+
+void dropCache(const FileEntryContainer& container) {
+#ifndef _WIN32
+    container.foreach([](const FileEntry& entry) {
+        const int fd = ::open(entry.getPath().c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            ::fdatasync(fd);
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fd);
+        }
+        return true;
+    });
+#else
+    (void)container;
+#endif
+}
+
+SeekProfile profile(const std::vector<const FileEntry*>& order) {
+    SeekProfile result;
+    std::optional<PhysicalLocation> previous;
+    for (const auto* entry : order) {
+        const auto location = AccessPlanner::locate(entry->getPath());
+        if (!location) {
+            ++result.unknown;
+            continue;
+        }
+        if (previous && previous->device == location->device) {
+            const auto end = previous->offset + previous->length;
+            if (location->offset >= end) {
+                result.distance += location->offset - end;
+            } else {
+                result.distance += end - location->offset;
+                ++result.backward;
+            }
+        }
+        previous = location;
+    }
+    return result;
+}
+
+const char* name(AccessOrder order) {
+    switch (order) {
+        case AccessOrder::Container:
+            return "container";
+        case AccessOrder::Inode:
+            return "inode";
+        case AccessOrder::PhysicalOffset:
+            return "physical";
+    }
+    return "";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    fs::path root;
+    bool synthetic = argc < 2;
+    if (synthetic) {
+        root = fs::temp_directory_path() / "fsil_access_order_bench";
+        fs::remove_all(root);
+        createSyntheticTree(root);
+    } else {
+        root = argv[1];
+    }
+
+    FileEntryContainer container;
+    FileScanner::getInstance().scan(root, container, [](const fs::path&) { return true; }, true);
+    std::cout << container.size() << " files below " << root << "\n\n";
+
+    // Stat pass: fetchMetadata plans its own order, so the time includes planning
+    bool cold = true;
+    std::cout << std::left << std::setw(12) << "order" << std::right << std::setw(12) << "stat ms"
+              << std::setw(14) << "files/s" << "\n";
+    for (auto order : {AccessOrder::Container, AccessOrder::Inode, AccessOrder::PhysicalOffset}) {
+        cold = dropMetadataCache() && cold;
+
+        size_t files = 0;
+        const auto start = std::chrono::steady_clock::now();
+        container.fetchMetadata([&files](const FileEntry&, const FileMetadata&) {
+            ++files;
+            return true;
+        }, order);
+        const std::chrono::duration<double, std::milli> statting = std::chrono::steady_clock::now() - start;
+
+        std::cout << std::left << std::setw(12) << name(order) << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << statting.count() << std::setw(14)
+                  << (statting.count() > 0 ? static_cast<double>(files) * 1e3 / statting.count() : 0.0) << "\n";
+    }
+    if (!cold) {
+        std::cout << "(caches could not be dropped: stat timings are warm, run as root for cold ones)\n";
+    }
+    std::cout << "\n";
+
+    std::cout << std::left << std::setw(12) << "order" << std::right << std::setw(12) << "plan ms"
+              << std::setw(12) << "read ms" << std::setw(12) << "MB/s" << std::setw(16) << "seek MB"
+              << std::setw(12) << "backward" << std::setw(10) << "unknown" << "\n";
+
+    for (auto order : {AccessOrder::Container, AccessOrder::Inode, AccessOrder::PhysicalOffset}) {
+        dropCache(container);
+
+        auto start = std::chrono::steady_clock::now();
+        const auto planned = container.accessOrder(order);
+        const std::chrono::duration<double, std::milli> planning = std::chrono::steady_clock::now() - start;
+
+        dropCache(container);
+        uintmax_t bytes = 0;
+        start = std::chrono::steady_clock::now();
+        container.readContents([&bytes](const FileEntry&, const std::string& content) {
+            bytes += content.size();
+            return true;
+        }, order);
+        const std::chrono::duration<double, std::milli> reading = std::chrono::steady_clock::now() - start;
+
+        const auto seeks = profile(planned);
+        std::cout << std::left << std::setw(12) << name(order) << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << planning.count() << std::setw(12) << reading.count() << std::setw(12)
+                  << (reading.count() > 0 ? static_cast<double>(bytes) / 1e3 / reading.count() : 0.0)
+                  << std::setw(16) << static_cast<double>(seeks.distance) / (1024.0 * 1024.0) << std::setw(12)
+                  << seeks.backward << std::setw(10) << seeks.unknown << "\n";
+    }
+
+    if (synthetic) {
+        fs::remove_all(root);
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+//
+// FileCopyBench.cpp
+// Compares FileCopier with cp -r and rsync -a for local-to-local copies and re-syncs
+//
+// Usage: FileCopyBench [directory]
+// Copies the directory (or synthetic trees of small and of large files created in the temp directory)
+// to a sibling target with each tool, then repeats the copy onto the unchanged target. FileCopier
+// times include the scan. Caches are dropped before every run when running as root; otherwise all
+// runs read a warm source. Tools that are not installed are reported as such.
+//
+
+#include "FileEntryContainer.h"
+#include "FileScanner.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Workload {
+    std::string name;
+    size_t files;
+    size_t fileSize;
+};
+
+void createTree(const fs::path& root, const Workload& workload) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> bytes(0, 255);
+    std::string data(workload.fileSize, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(bytes(random));
+    }
+
+    for (size_t i = 0; i < workload.files; ++i) {
+        const auto directory = root / ("dir" + std::to_string(i % 64));
+        fs::create_directories(directory);
+        // Vary the first bytes so no two files are identical
+        data[0] = static_cast<char>(i);
+        data[1] = static_cast<char>(i >> 8);
+        std::ofstream(directory / ("file" + std::to_string(i) + ".dat"), std::ios::binary)
+                .write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+}
+
+// Writes back dirty pages and drops the page, dentry and inode caches; Linux, root only
+bool dropCaches() {
+#ifdef __linux__
+    ::sync();
+    std::ofstream control("/proc/sys/vm/drop_caches");
+    control << "3" << std::flush;
+    return static_cast<bool>(control);
+#else
+    return false;
+#endif
+}
+
+bool available(const std::string& tool) {
+    return std::system(("command -v " + tool + " >/dev/null 2>&1").c_str()) == 0;
+}
+
+// Wall time of a shell command, or nothing if it failed
+std::optional<double> timeCommand(const std::string& command) {
+    const auto start = std::chrono::steady_clock::now();
+    if (std::system(command.c_str()) != 0) {
+        return std::nullopt;
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+double timeFileCopier(const fs::path& source, const fs::path& target, unsigned maxParallel) {
+    const auto start = std::chrono::steady_clock::now();
+    FileEntryContainer entries;
+    FileScanner::getInstance().scan(source, entries, [](const fs::path&) { return true; }, true);
+    CopyOptions options;
+    options.maxParallel = maxParallel;
+    const auto stats = entries.copyTo(source, target, options);
+    if (stats.filesFailed != 0) {
+        std::cerr << stats.filesFailed << " files failed to copy\n";
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const std::string& tool, std::optional<double> copy, std::optional<double> resync) {
+    const auto cell = [](std::optional<double> value) {
+        std::ostringstream out;
+        if (value) {
+            out << std::fixed << std::setprecision(1) << *value;
+        } else {
+            out << "n/a";
+        }
+        return out.str();
+    };
+    std::cout << std::left << std::setw(20) << tool << std::right << std::setw(12) << cell(copy) << std::setw(12)
+              << cell(resync) << "\n";
+}
+
+void run(const fs::path& source, const fs::path& scratch, const std::string& label) {
+    std::cout << label << "\n";
+    std::cout << std::left << std::setw(20) << "tool" << std::right << std::setw(12) << "copy ms" << std::setw(12)
+              << "resync ms" << "\n";
+
+    const auto quoted = [](const fs::path& path) { return "'" + path.string() + "'"; };
+    bool cold = true;
+
+    for (unsigned maxParallel : {1u, 4u, 16u}) {
+        const auto target = scratch / "filecopier";
+        fs::remove_all(target);
+        cold = dropCaches() && cold;
+        const double copy = timeFileCopier(source, target, maxParallel);
+        cold = dropCaches() && cold;
+        const double resync = timeFileCopier(source, target, maxParallel);
+        report("FileCopier x" + std::to_string(maxParallel), copy, resync);
+        fs::remove_all(target);
+    }
+
+    {
+        const auto target = scratch / "cp";
+        fs::remove_all(target);
+        cold = dropCaches() && cold;
+        const auto copy = timeCommand("cp -r " + quoted(source) + " " + quoted(target));
+        // Onto an existing target cp -r nests the tree, so copy the contents instead
+        cold = dropCaches() && cold;
+        const auto resync = timeCommand("cp -r " + quoted(source) + "/. " + quoted(target));
+        report("cp -r", copy, resync);
+        fs::remove_all(target);
+    }
+
+    if (available("rsync")) {
+        const auto target = scratch / "rsync";
+        fs::remove_all(target);
+        cold = dropCaches() && cold;
+        const auto copy = timeCommand("rsync -a " + quoted(source) + "/ " + quoted(target));
+        cold = dropCaches() && cold;
+        const auto resync = timeCommand("rsync -a " + quoted(source) + "/ " + quoted(target));
+        report("rsync -a", copy, resync);
+        fs::remove_all(target);
+    } else {
+        std::cout << "rsync -a            not installed\n";
+    }
+
+    if (!cold) {
+        std::cout << "(caches could not be dropped: the source was read warm, run as root for cold runs)\n";
+    }
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const auto scratch = fs::temp_directory_path() / "fsil_file_copy_bench";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+
+    if (argc >= 2) {
+        run(argv[1], scratch, fs::path(argv[1]).string());
+    } else {
+        for (const auto& workload : {Workload{"small", 20000, 4 * 1024}, Workload{"large", 2000, 256 * 1024}}) {
+            const auto source = scratch / ("source_" + workload.name);
+            createTree(source, workload);
+            run(source, scratch,
+                std::to_string(workload.files) + " x " + std::to_string(workload.fileSize / 1024) + "KB files");
+            fs::remove_all(source);
+        }
+    }
+
+    fs::remove_all(scratch);
+    return 0;
+}
@@ -0,0 +1,146 @@
+//
+// AccessPlanner.cpp
+// Orders batch metadata and content access to reduce seeks on rotational media
+//
+
+#include "AccessPlanner.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#endif
+
+namespace {
+
+constexpr uint64_t kUnknown = std::numeric_limits<uint64_t>::max();
+
+// (device, inode number) of every entry, read from the listings of their parent directories.
+// Inode numbers are only unique per device, so the device comes first like in physical order.
+std::vector<std::pair<uint64_t, uint64_t>> inodesOf(const FileEntryVec& entries) {
+    std::vector<std::pair<uint64_t, uint64_t>> inodes(entries.size(), {kUnknown, kUnknown});
+
+#ifndef _WIN32
+    std::unordered_map<std::string, std::unordered_map<std::string, size_t>> byDirectory;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto& path = entries[i]->getPath();
+        byDirectory[path.parent_path().string()].emplace(path.filename().string(), i);
+    }
+
+    for (const auto& [directory, names] : byDirectory) {
+        DIR* stream = opendir(directory.empty() ? "." : directory.c_str());
+        if (stream == nullptr) {
+            continue;
+        }
+        // Entries share the device of their directory (a mount point is listed with the parent's inode)
+        struct stat directoryStat{};
+        if (::fstat(dirfd(stream), &directoryStat) != 0) {
+            closedir(stream);
+            continue;
+        }
+        const auto device = static_cast<uint64_t>(directoryStat.st_dev);
+        while (const dirent* entry = readdir(stream)) {
+            const auto found = names.find(entry->d_name);
+            if (found != names.end()) {
+                inodes[found->second] = {device, static_cast<uint64_t>(entry->d_ino)};
+            }
+        }
+        closedir(stream);
+    }
+#endif
+
+    return inodes;
+}
+
+// Stable sort of the indexes by key; unknown keys sort last
+template <typename Key>
+std::vector<size_t> sortedIndexes(const std::vector<Key>& keys) {
+    std::vector<size_t> indexes(keys.size());
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        indexes[i] = i;
+    }
+    std::stable_sort(indexes.begin(), indexes.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+    return indexes;
+}
+
+} // namespace
+
+std::vector<const FileEntry*> AccessPlanner::plan(const FileEntryVec& entries, AccessOrder order) {
+    std::vector<const FileEntry*> planned;
+    planned.reserve(entries.size());
+
+    if (order == AccessOrder::Container) {
+        for (const auto& entry : entries) {
+            planned.push_back(entry.get());
+        }
+        return planned;
+    }
+
+    const auto byInode = sortedIndexes(inodesOf(entries));
+    if (order == AccessOrder::Inode) {
+        for (const auto index : byInode) {
+            planned.push_back(entries[index].get());
+        }
+        return planned;
+    }
+
+    // Probe the locations in inode order, then sort by (device, offset)
+    std::vector<std::tuple<uint64_t, uint64_t, size_t>> keys(entries.size());
+    for (size_t rank = 0; rank < byInode.size(); ++rank) {
+        const auto index = byInode[rank];
+        const auto location = locate(entries[index]->getPath());
+        keys[index] = location ? std::make_tuple(location->device, location->offset, rank)
+                               : std::make_tuple(kUnknown, kUnknown, rank);
+    }
+    for (const auto index : sortedIndexes(keys)) {
+        planned.push_back(entries[index].get());
+    }
+    return planned;
+}
+
+std::optional<PhysicalLocation> AccessPlanner::locate(const std::filesystem::path& path) {
+#ifdef __linux__
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+
+    struct stat fileStat{};
+    // Room for the request header and a single extent
+    alignas(struct fiemap) unsigned char buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {};
+    auto* map = reinterpret_cast<struct fiemap*>(buffer);
+    map->fm_start = 0;
+    map->fm_length = FIEMAP_MAX_OFFSET;
+    map->fm_extent_count = 1;
+
+    const bool mapped = ::fstat(fd, &fileStat) == 0 && ::ioctl(fd, FS_IOC_FIEMAP, map) == 0 && map->fm_mapped_extents > 0;
+    ::close(fd);
+
+    // Delayed allocation: the data has no place on disk yet
+    if (!mapped || (map->fm_extents[0].fe_flags & FIEMAP_EXTENT_UNKNOWN)) {
+        return std::nullopt;
+    }
+
+    PhysicalLocation location;
+    location.device = static_cast<uint64_t>(fileStat.st_dev);
+    location.offset = map->fm_extents[0].fe_physical;
+    location.length = map->fm_extents[0].fe_length;
+    return location;
+#else
+    (void)path;
+    return std::nullopt;
+#endif
+}
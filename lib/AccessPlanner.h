@@ -0,0 +1,41 @@
+//
+// AccessPlanner.h
+// Orders batch metadata and content access to reduce seeks on rotational media
+//
+
+#ifndef ACCESSPLANNER_H
+#define ACCESSPLANNER_H
+
+#include "FileEntry.h"
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+enum class AccessOrder {
+    Container,        // As stored in the container
+    Inode,            // By device and inode number; inode tables are laid out in inode order
+    PhysicalOffset,   // By the on-disk offset of the first data extent (Linux FIEMAP)
+};
+
+// Where the data of a file starts on its device
+struct PhysicalLocation {
+    uint64_t device = 0;
+    uint64_t offset = 0;
+    uint64_t length = 0;    // Length of the first extent
+};
+
+// Computes the order in which a batch of files should be visited. Inode numbers come
+// from one readdir (and one fstat) of each parent directory, so ordering stats costs
+// no stats of the files themselves. Physical
+// offsets need an open and a FIEMAP ioctl per file (no data is read); those probes are
+// issued in inode order. Files without a known location keep their relative order and
+// go last. Outside Linux both orders degrade gracefully to container order.
+class AccessPlanner {
+public:
+    [[nodiscard]] static std::vector<const FileEntry*> plan(const FileEntryVec& entries, AccessOrder order);
+
+    [[nodiscard]] static std::optional<PhysicalLocation> locate(const std::filesystem::path& path);
+};
+
+#endif // ACCESSPLANNER_H
@@ -0,0 +1,668 @@
+//
+// ContentStream.cpp
+// Sequential reader over file content with transparent decompression
+//
+
+#include "ContentStream.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef FSIL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef FSIL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// Bytes read from disk at a time by the sequential decoders
+constexpr size_t kInputChunk = 128 * 1024;
+
+// Compressed bytes handed to one parallel decompression task
+constexpr size_t kBatchBytes = 1024 * 1024;
+
+// Decompressed bytes one parallel task may produce. Highly compressible input would
+// otherwise inflate a kBatchBytes batch without bound; zstd frames declaring more
+// than this are streamed instead.
+constexpr uint64_t kBatchOutputBytes = 4ULL * 1024 * 1024;
+
+// Largest uncompressed size of a BGZF block
+constexpr uint64_t kMaxBgzfBlockContent = 64 * 1024;
+
+// Enough to cover a zstd frame header and a typical BGZF gzip header
+constexpr size_t kHeaderBytes = 32;
+
+constexpr uint32_t kZstdMagic = 0xFD2FB528u;
+
+uint16_t readLE16(const unsigned char* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint32_t readLE32(const unsigned char* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+size_t readSome(std::istream& in, char* buffer, size_t length) {
+    in.read(buffer, static_cast<std::streamsize>(length));
+    return static_cast<size_t>(in.gcount());
+}
+
+void readExact(std::istream& in, char* buffer, size_t length, const char* what) {
+    if (readSome(in, buffer, length) != length) {
+        throw std::runtime_error(std::string("Truncated ") + what);
+    }
+}
+
+std::ifstream openFile(const std::filesystem::path& path) {
+    if (!std::filesystem::exists(path)) {
+        throw std::runtime_error("File does not exist");
+    }
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + path.string());
+    }
+    return file;
+}
+
+std::string readHeader(const std::filesystem::path& path) {
+    auto file = openFile(path);
+    std::string header(kHeaderBytes, '\0');
+    header.resize(readSome(file, header.data(), header.size()));
+    return header;
+}
+
+// Size of the BGZF block described by a gzip extra field, or 0 if it has no BC subfield
+size_t bgzfBlockSize(const unsigned char* extra, size_t length) {
+    size_t pos = 0;
+    while (pos + 4 <= length) {
+        const uint16_t subfieldLength = readLE16(extra + pos + 2);
+        if (extra[pos] == 'B' && extra[pos + 1] == 'C' && subfieldLength == 2 && pos + 6 <= length) {
+            return static_cast<size_t>(readLE16(extra + pos + 4)) + 1;
+        }
+        pos += 4 + subfieldLength;
+    }
+    return 0;
+}
+
+ContentStream::Format formatOf(const std::string& header) {
+    const auto* data = reinterpret_cast<const unsigned char*>(header.data());
+
+    if (header.size() >= 4 && readLE32(data) == kZstdMagic) {
+        return ContentStream::Format::Zstd;
+    }
+    if (header.size() >= 3 && data[0] == 0x1f && data[1] == 0x8b && data[2] == 8) {
+        // FEXTRA with a BC subfield marks a BGZF file
+        if (header.size() >= 12 && (data[3] & 0x04)) {
+            const size_t extraLength = std::min<size_t>(readLE16(data + 10), header.size() - 12);
+            if (bgzfBlockSize(data + 12, extraLength) != 0) {
+                return ContentStream::Format::Bgzf;
+            }
+        }
+        return ContentStream::Format::Gzip;
+    }
+    return ContentStream::Format::Raw;
+}
+
+class RawContentStream : public ContentStream {
+public:
+    explicit RawContentStream(std::ifstream file) : file(std::move(file)) {}
+
+    size_t read(char* buffer, size_t length) override {
+        return readSome(file, buffer, length);
+    }
+
+private:
+    std::ifstream file;
+};
+
+// An independently decodable unit of compressed input
+struct Frame {
+    std::string data;
+    uint64_t contentSize = 0;
+    bool hasContentSize = false;
+    // Too large to buffer: data holds only the frame header, the rest is still in the stream
+    bool sequential = false;
+};
+
+// Decompresses independent frames in batches, one batch per task, and hands the
+// results out in order. At most `threads` batches are in flight at any time, each
+// limited to kBatchBytes of input and kBatchOutputBytes of declared output.
+//
+// A frame the reader marks sequential is decoded on the calling thread by the stream
+// the SequentialDecoder returns, reading from the file directly; no frames are read
+// ahead until it is done.
+class ParallelFrameStream : public ContentStream {
+public:
+    using FrameReader = std::function<bool(std::istream&, Frame&)>;
+    using FrameDecoder = std::function<void(const Frame&, std::string&)>;
+    using SequentialDecoder = std::function<ContentStreamPtr(std::istream&, Frame)>;
+
+    ParallelFrameStream(std::ifstream file, FrameReader reader, FrameDecoder decoder, unsigned threads,
+                        SequentialDecoder sequentialDecoder = nullptr)
+        : file(std::move(file)), reader(std::move(reader)), decoder(std::move(decoder)),
+          sequentialDecoder(std::move(sequentialDecoder)), threads(threads) {}
+
+    size_t read(char* buffer, size_t length) override {
+        size_t total = 0;
+        while (total < length) {
+            if (sequential) {
+                const size_t count = sequential->read(buffer + total, length - total);
+                if (count == 0) {
+                    sequential.reset();
+                    blocked = false;
+                }
+                total += count;
+                continue;
+            }
+            if (offset == current.size()) {
+                if (!next()) {
+                    break;
+                }
+                continue;
+            }
+            const size_t count = std::min(length - total, current.size() - offset);
+            std::memcpy(buffer + total, current.data() + offset, count);
+            offset += count;
+            total += count;
+        }
+        return total;
+    }
+
+    [[nodiscard]] size_t bufferedBytes() const override {
+        size_t bytes = current.size() - offset;
+        for (const auto& item : pending) {
+            bytes += item.contentBytes;
+        }
+        return sequential ? bytes + sequential->bufferedBytes() : bytes;
+    }
+
+private:
+    bool next() {
+        schedule();
+        if (pending.empty()) {
+            return false;
+        }
+        Pending item = std::move(pending.front());
+        pending.pop_front();
+        current.clear();
+        offset = 0;
+        if (item.sequentialFrame) {
+            if (!sequentialDecoder) {
+                throw std::runtime_error("Frame too large to decode");
+            }
+            sequential = sequentialDecoder(file, std::move(*item.sequentialFrame));
+            return true;
+        }
+        current = item.output.get();
+        schedule();
+        return true;
+    }
+
+    void schedule() {
+        while ((!exhausted || carried) && !blocked && pending.size() < threads) {
+            std::vector<Frame> batch;
+            std::optional<Frame> sequentialFrame;
+            size_t bytes = 0;
+            uint64_t contentBytes = 0;
+            while (bytes < kBatchBytes) {
+                Frame frame;
+                if (carried) {
+                    frame = std::move(*carried);
+                    carried.reset();
+                } else if (!reader(file, frame)) {
+                    exhausted = true;
+                    break;
+                }
+                if (frame.sequential) {
+                    sequentialFrame = std::move(frame);
+                    blocked = true;
+                    break;
+                }
+                // Starts the next batch instead
+                if (!batch.empty() && contentBytes + frame.contentSize > kBatchOutputBytes) {
+                    carried = std::move(frame);
+                    break;
+                }
+                bytes += frame.data.size();
+                contentBytes += frame.contentSize;
+                batch.push_back(std::move(frame));
+            }
+            if (!batch.empty()) {
+                Pending item;
+                item.contentBytes = static_cast<size_t>(contentBytes);
+                item.output = std::async(std::launch::async, [decoder = decoder, batch = std::move(batch)]() {
+                    std::string output;
+                    for (const auto& frame : batch) {
+                        decoder(frame, output);
+                    }
+                    return output;
+                });
+                pending.push_back(std::move(item));
+            }
+            if (sequentialFrame) {
+                Pending item;
+                item.sequentialFrame = std::move(sequentialFrame);
+                pending.push_back(std::move(item));
+            }
+        }
+    }
+
+    // A decoded batch, or a frame to be decoded sequentially once everything before it is handed out
+    struct Pending {
+        std::future<std::string> output;
+        size_t contentBytes = 0;
+        std::optional<Frame> sequentialFrame;
+    };
+
+    std::ifstream file;
+    FrameReader reader;
+    FrameDecoder decoder;
+    SequentialDecoder sequentialDecoder;
+    unsigned threads;
+    bool exhausted = false;
+    // Read but did not fit the previous batch
+    std::optional<Frame> carried;
+    // Set while a sequential frame is queued or being decoded: the file is positioned inside it
+    bool blocked = false;
+    std::deque<Pending> pending;
+    ContentStreamPtr sequential;
+    std::string current;
+    size_t offset = 0;
+};
+
+#ifdef FSIL_HAVE_ZLIB
+
+// Plain (possibly multi-member) gzip or zlib stream, decoded sequentially
+class GzipContentStream : public ContentStream {
+public:
+    explicit GzipContentStream(std::ifstream file) : file(std::move(file)), input(kInputChunk) {
+        // 15 + 32: maximum window, detect gzip or zlib header automatically
+        if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+            throw std::runtime_error("Could not initialise gzip decompression");
+        }
+    }
+
+    ~GzipContentStream() override {
+        inflateEnd(&stream);
+    }
+
+    size_t read(char* buffer, size_t length) override {
+        length = std::min<size_t>(length, std::numeric_limits<uInt>::max());
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = static_cast<uInt>(length);
+
+        while (stream.avail_out > 0 && !finished) {
+            if (stream.avail_in == 0) {
+                const size_t count = readSome(file, input.data(), input.size());
+                if (count == 0) {
+                    if (inMember) {
+                        throw std::runtime_error("Truncated gzip stream");
+                    }
+                    finished = true;
+                    break;
+                }
+                stream.next_in = reinterpret_cast<Bytef*>(input.data());
+                stream.avail_in = static_cast<uInt>(count);
+            }
+
+            if (!inMember) {
+                // Another member follows only if it starts with the gzip magic; anything else is padding
+                if (stream.next_in[0] != 0x1f) {
+                    finished = true;
+                    break;
+                }
+                inflateReset(&stream);
+                inMember = true;
+            }
+
+            const int result = inflate(&stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END) {
+                inMember = false;
+            } else if (result != Z_OK && result != Z_BUF_ERROR) {
+                throw std::runtime_error("Corrupt gzip stream");
+            }
+        }
+
+        return length - stream.avail_out;
+    }
+
+private:
+    std::ifstream file;
+    std::vector<char> input;
+    z_stream stream{};
+    bool inMember = true;
+    bool finished = false;
+};
+
+bool readBgzfBlock(std::istream& in, Frame& frame) {
+    std::array<unsigned char, 12> header{};
+    const size_t count = readSome(in, reinterpret_cast<char*>(header.data()), header.size());
+    if (count == 0) {
+        return false;
+    }
+    if (count < header.size() || header[0] != 0x1f || header[1] != 0x8b || !(header[3] & 0x04)) {
+        throw std::runtime_error("Corrupt BGZF block");
+    }
+
+    const uint16_t extraLength = readLE16(header.data() + 10);
+    std::string extra(extraLength, '\0');
+    readExact(in, extra.data(), extra.size(), "BGZF block");
+
+    const size_t blockSize = bgzfBlockSize(reinterpret_cast<const unsigned char*>(extra.data()), extra.size());
+    if (blockSize < header.size() + extraLength + 8) {
+        throw std::runtime_error("Corrupt BGZF block");
+    }
+
+    frame.data.resize(blockSize);
+    std::memcpy(frame.data.data(), header.data(), header.size());
+    std::memcpy(frame.data.data() + header.size(), extra.data(), extra.size());
+    const size_t headerSize = header.size() + extra.size();
+    readExact(in, frame.data.data() + headerSize, blockSize - headerSize, "BGZF block");
+
+    // ISIZE trailer: uncompressed size of the block (at most 64KB)
+    frame.contentSize = readLE32(reinterpret_cast<const unsigned char*>(frame.data.data()) + blockSize - 4);
+    if (frame.contentSize > kMaxBgzfBlockContent) {
+        throw std::runtime_error("Corrupt BGZF block");
+    }
+    frame.hasContentSize = true;
+    return true;
+}
+
+void inflateBgzfBlock(const Frame& frame, std::string& output) {
+    const size_t start = output.size();
+    // One spare byte so an empty block still has room to reach the end of the stream
+    output.resize(start + frame.contentSize + 1);
+
+    z_stream stream{};
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        throw std::runtime_error("Could not initialise gzip decompression");
+    }
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(frame.data.data()));
+    stream.avail_in = static_cast<uInt>(frame.data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data() + start);
+    stream.avail_out = static_cast<uInt>(frame.contentSize + 1);
+
+    const int result = inflate(&stream, Z_FINISH);
+    const uLong produced = stream.total_out;
+    inflateEnd(&stream);
+
+    if (result != Z_STREAM_END || produced != frame.contentSize) {
+        throw std::runtime_error("Corrupt BGZF block");
+    }
+    output.resize(start + frame.contentSize);
+}
+
+#endif // FSIL_HAVE_ZLIB
+
+#ifdef FSIL_HAVE_ZSTD
+
+uint64_t readLE(const unsigned char* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+struct ZstdFrameHeader {
+    size_t size = 0;             // Bytes after the magic number
+    bool hasContentSize = false;
+    uint64_t contentSize = 0;
+    bool hasChecksum = false;
+};
+
+// Decodes the frame header following the magic number; returns false if data is too short
+bool parseZstdFrameHeader(const unsigned char* data, size_t length, ZstdFrameHeader& header) {
+    if (length < 1) {
+        return false;
+    }
+    const unsigned char descriptor = data[0];
+    const unsigned contentSizeFlag = descriptor >> 6;
+    const bool singleSegment = (descriptor >> 5) & 1;
+    static constexpr size_t dictionaryIdSizes[] = {0, 1, 2, 4};
+    static constexpr size_t contentSizeSizes[] = {0, 2, 4, 8};
+
+    const size_t dictionaryIdSize = dictionaryIdSizes[descriptor & 3];
+    const size_t contentSizeSize = contentSizeFlag == 0 ? (singleSegment ? 1 : 0) : contentSizeSizes[contentSizeFlag];
+    const size_t windowSize = singleSegment ? 0 : 1;
+
+    header.size = 1 + windowSize + dictionaryIdSize + contentSizeSize;
+    if (length < header.size) {
+        return false;
+    }
+
+    header.hasChecksum = (descriptor >> 2) & 1;
+    header.hasContentSize = contentSizeSize != 0;
+    if (header.hasContentSize) {
+        header.contentSize = readLE(data + 1 + windowSize + dictionaryIdSize, contentSizeSize);
+        if (contentSizeSize == 2) {
+            header.contentSize += 256;
+        }
+    }
+    return true;
+}
+
+// Appends the next block of a zstd frame (header and payload) to data; returns true for the last block
+bool readZstdBlock(std::istream& in, std::string& data) {
+    std::array<unsigned char, 3> blockHeader{};
+    readExact(in, reinterpret_cast<char*>(blockHeader.data()), blockHeader.size(), "zstd frame");
+    const uint32_t value = static_cast<uint32_t>(readLE(blockHeader.data(), blockHeader.size()));
+    const uint32_t type = (value >> 1) & 3;
+    const uint32_t blockSize = value >> 3;
+    if (type == 3) {
+        throw std::runtime_error("Corrupt zstd frame");
+    }
+
+    // RLE blocks store a single byte regardless of their regenerated size
+    const size_t payload = type == 1 ? 1 : blockSize;
+    const size_t start = data.size();
+    data.append(reinterpret_cast<const char*>(blockHeader.data()), blockHeader.size());
+    data.resize(start + blockHeader.size() + payload);
+    readExact(in, data.data() + start + blockHeader.size(), payload, "zstd frame");
+    return value & 1;
+}
+
+// Decodes one zstd frame too large to buffer, block by block, straight from the stream.
+// Starts with the frame's magic number and header, as read by readZstdFrame, and never
+// reads past the end of the frame, so the frames following it are left in the stream.
+class ZstdFrameStream : public ContentStream {
+public:
+    ZstdFrameStream(std::istream& file, Frame frame)
+        : file(file), input(std::move(frame.data)), stream(ZSTD_createDStream()) {
+        if (stream == nullptr || ZSTD_isError(ZSTD_initDStream(stream))) {
+            ZSTD_freeDStream(stream);
+            throw std::runtime_error("Could not initialise zstd decompression");
+        }
+        ZstdFrameHeader header;
+        parseZstdFrameHeader(reinterpret_cast<const unsigned char*>(input.data()) + 4, input.size() - 4, header);
+        checksumPending = header.hasChecksum;
+    }
+
+    ~ZstdFrameStream() override {
+        ZSTD_freeDStream(stream);
+    }
+
+    size_t read(char* buffer, size_t length) override {
+        ZSTD_outBuffer out{buffer, length, 0};
+
+        while (out.pos < out.size && !finished) {
+            if (position == input.size() && !endOfFrame()) {
+                input.clear();
+                position = 0;
+                if (!lastBlock) {
+                    lastBlock = readZstdBlock(file, input);
+                } else {
+                    input.resize(4);
+                    readExact(file, input.data(), input.size(), "zstd frame");
+                    checksumPending = false;
+                }
+            }
+
+            ZSTD_inBuffer in{input.data(), input.size(), position};
+            const size_t before = out.pos;
+            const size_t result = ZSTD_decompressStream(stream, &out, &in);
+            position = in.pos;
+            if (ZSTD_isError(result)) {
+                throw std::runtime_error(std::string("Corrupt zstd stream: ") + ZSTD_getErrorName(result));
+            }
+
+            // 0: the frame is complete and flushed
+            if (result == 0) {
+                finished = true;
+            } else if (endOfFrame() && position == input.size() && out.pos == before) {
+                throw std::runtime_error("Corrupt zstd frame");
+            }
+        }
+
+        return out.pos;
+    }
+
+private:
+    [[nodiscard]] bool endOfFrame() const {
+        return lastBlock && !checksumPending;
+    }
+
+    std::istream& file;
+    std::string input;     // Header, then one block (or the checksum) at a time
+    size_t position = 0;
+    ZSTD_DStream* stream;
+    bool lastBlock = false;
+    bool checksumPending = false;
+    bool finished = false;
+};
+
+// Reads one zstd frame by walking its block headers, skipping skippable frames. Frames
+// without a declared size or larger than kBatchOutputBytes are only read up to their
+// header and marked sequential; their blocks are left for ZstdFrameStream.
+bool readZstdFrame(std::istream& in, Frame& frame) {
+    std::array<unsigned char, 4> magicBytes{};
+    for (;;) {
+        const size_t count = readSome(in, reinterpret_cast<char*>(magicBytes.data()), magicBytes.size());
+        if (count == 0) {
+            return false;
+        }
+        if (count < magicBytes.size()) {
+            throw std::runtime_error("Truncated zstd frame");
+        }
+
+        const uint32_t magic = readLE32(magicBytes.data());
+        if ((magic & 0xFFFFFFF0u) == 0x184D2A50u) {
+            std::array<unsigned char, 4> sizeBytes{};
+            readExact(in, reinterpret_cast<char*>(sizeBytes.data()), sizeBytes.size(), "zstd frame");
+            in.ignore(readLE32(sizeBytes.data()));
+            continue;
+        }
+        if (magic != kZstdMagic) {
+            throw std::runtime_error("Corrupt zstd frame");
+        }
+        break;
+    }
+
+    frame.data.assign(reinterpret_cast<const char*>(magicBytes.data()), magicBytes.size());
+
+    // The descriptor byte determines the length of the rest of the header
+    std::array<unsigned char, 14> header{};
+    readExact(in, reinterpret_cast<char*>(header.data()), 1, "zstd frame");
+    ZstdFrameHeader parsed;
+    if (!parseZstdFrameHeader(header.data(), 1, parsed)) {
+        readExact(in, reinterpret_cast<char*>(header.data()) + 1, parsed.size - 1, "zstd frame");
+        parseZstdFrameHeader(header.data(), parsed.size, parsed);
+    }
+    frame.data.append(reinterpret_cast<const char*>(header.data()), parsed.size);
+    frame.hasContentSize = parsed.hasContentSize;
+    frame.contentSize = parsed.contentSize;
+
+    if (!parsed.hasContentSize || parsed.contentSize > kBatchOutputBytes) {
+        frame.sequential = true;
+        return true;
+    }
+
+    while (!readZstdBlock(in, frame.data)) {
+    }
+
+    if (parsed.hasChecksum) {
+        const size_t start = frame.data.size();
+        frame.data.resize(start + 4);
+        readExact(in, frame.data.data() + start, 4, "zstd frame");
+    }
+    return true;
+}
+
+void decompressZstdFrame(const Frame& frame, std::string& output) {
+    const size_t start = output.size();
+    output.resize(start + frame.contentSize);
+    const size_t result = ZSTD_decompress(output.data() + start, frame.contentSize, frame.data.data(), frame.data.size());
+    if (ZSTD_isError(result) || result != frame.contentSize) {
+        throw std::runtime_error("Corrupt zstd frame");
+    }
+}
+
+ContentStreamPtr streamZstdFrame(std::istream& in, Frame frame) {
+    return std::make_unique<ZstdFrameStream>(in, std::move(frame));
+}
+
+#endif // FSIL_HAVE_ZSTD
+
+} // namespace
+
+ContentStream::Format ContentStream::detectFormat(const std::filesystem::path& path) {
+    return formatOf(readHeader(path));
+}
+
+ContentStreamPtr ContentStream::open(const std::filesystem::path& path, unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const std::string header = readHeader(path);
+    auto file = openFile(path);
+
+    switch (formatOf(header)) {
+        case Format::Raw:
+            return std::make_unique<RawContentStream>(std::move(file));
+
+        case Format::Gzip:
+#ifdef FSIL_HAVE_ZLIB
+            return std::make_unique<GzipContentStream>(std::move(file));
+#else
+            throw std::runtime_error("gzip support is not available: " + path.string());
+#endif
+
+        case Format::Bgzf:
+#ifdef FSIL_HAVE_ZLIB
+            return std::make_unique<ParallelFrameStream>(std::move(file), readBgzfBlock, inflateBgzfBlock, threads);
+#else
+            throw std::runtime_error("gzip support is not available: " + path.string());
+#endif
+
+        case Format::Zstd: {
+#ifdef FSIL_HAVE_ZSTD
+            // Frames with a modest declared size are decoded in parallel; huge or unsized
+            // frames are streamed block by block, so memory stays bounded
+            return std::make_unique<ParallelFrameStream>(std::move(file), readZstdFrame, decompressZstdFrame, threads,
+                                                         streamZstdFrame);
+#else
+            throw std::runtime_error("zstd support is not available: " + path.string());
+#endif
+        }
+    }
+
+    throw std::runtime_error("Unsupported content format: " + path.string());
+}
@@ -0,0 +1,50 @@
+//
+// ContentStream.h
+// Sequential reader over file content with transparent decompression
+//
+
+#ifndef CONTENTSTREAM_H
+#define CONTENTSTREAM_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+class ContentStream;
+
+using ContentStreamPtr = std::unique_ptr<ContentStream>;
+
+// Reads the content of a file, decompressing it on the fly when the magic bytes
+// identify a gzip or zstd stream. Only a bounded window of the content is held
+// in memory, so arbitrarily large files can be consumed piece by piece.
+//
+// BGZF (bgzip) files and zstd files made of multiple frames with a declared
+// content size are decompressed in parallel, a batch of frames per thread. Unsized
+// or very large zstd frames among them are decoded block by block.
+class ContentStream {
+public:
+    enum class Format {
+        Raw,
+        Gzip,
+        Bgzf,
+        Zstd,
+    };
+
+    virtual ~ContentStream() = default;
+
+    // Reads up to length bytes into buffer; returns 0 once the content is exhausted
+    virtual size_t read(char* buffer, size_t length) = 0;
+
+    // Decompressed bytes held in memory ahead of the reader, for diagnostics
+    [[nodiscard]] virtual size_t bufferedBytes() const {
+        return 0;
+    }
+
+    [[nodiscard]] static Format detectFormat(const std::filesystem::path& path);
+
+    // Opens the content of path for reading. threads limits parallel frame
+    // decompression; 0 uses the hardware concurrency.
+    static ContentStreamPtr open(const std::filesystem::path& path, unsigned threads = 0);
+};
+
+#endif // CONTENTSTREAM_H
@@ -0,0 +1,204 @@
+//
+// DirectoryComparator.cpp
+// Tree-to-tree comparison of two directories
+//
+
+#include "DirectoryComparator.h"
+#include "FileEntry.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+
+struct Listing {
+    std::string name;
+    std::filesystem::file_type type;
+};
+
+// Sorted names of a directory with their (non-followed) types; false if it cannot be read
+bool listDirectory(const std::filesystem::path& directory, std::vector<Listing>& listing) {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(directory, ec);
+    if (ec) {
+        return false;
+    }
+    for (const std::filesystem::directory_iterator end; it != end; it.increment(ec)) {
+        if (ec) {
+            return false;
+        }
+        listing.push_back({it->path().filename().string(), it->symlink_status(ec).type()});
+    }
+    if (ec) {
+        return false;
+    }
+
+    std::sort(listing.begin(), listing.end(), [](const Listing& a, const Listing& b) { return a.name < b.name; });
+    return true;
+}
+
+bool sameInode(const FileMetadata& a, const FileMetadata& b) {
+    return a.inode != 0 && a.device == b.device && a.inode == b.inode;
+}
+
+bool sameFile(const std::filesystem::path& source, const std::filesystem::path& target, ContentCheck contentCheck) {
+    const auto sourceMetadata = FileEntry::readMetadata(source);
+    const auto targetMetadata = FileEntry::readMetadata(target);
+    if (!sourceMetadata || !targetMetadata) {
+        return false;
+    }
+    if (sameInode(*sourceMetadata, *targetMetadata)) {
+        return true;
+    }
+    if (sourceMetadata->size != targetMetadata->size) {
+        return false;
+    }
+
+    const bool sameTime = sourceMetadata->modificationTime == targetMetadata->modificationTime;
+    switch (contentCheck) {
+        case ContentCheck::Never:
+            return sameTime;
+        case ContentCheck::WhenNeeded:
+            if (sameTime) {
+                return true;
+            }
+            break;
+        case ContentCheck::Always:
+            break;
+    }
+
+    try {
+        return FileEntry(source).hasSameContent(FileEntry(target));
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool sameSymlink(const std::filesystem::path& source, const std::filesystem::path& target) {
+    std::error_code sourceError;
+    std::error_code targetError;
+    const auto sourceLink = std::filesystem::read_symlink(source, sourceError);
+    const auto targetLink = std::filesystem::read_symlink(target, targetError);
+    return !sourceError && !targetError && sourceLink == targetLink;
+}
+
+} // namespace
+
+DirectoryComparator::DirectoryComparator(CompareOptions options) : options(options) {
+}
+
+DirectoryDiff DirectoryComparator::compare(const std::filesystem::path& source, const std::filesystem::path& target) const {
+    if (!std::filesystem::is_directory(source) || !std::filesystem::is_directory(target)) {
+        throw std::runtime_error("Directory does not exist");
+    }
+
+    DirectoryDiff diff;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::filesystem::path> pending{std::filesystem::path()};
+    size_t active = 0;
+
+    // Compares one directory pair; returns the subdirectory pairs still to visit
+    auto compareDirectory = [&](const std::filesystem::path& relative, DirectoryDiff& result) {
+        std::vector<std::filesystem::path> subdirectories;
+        const auto sourceDirectory = source / relative;
+        const auto targetDirectory = target / relative;
+
+        const auto sourceMetadata = FileEntry::readMetadata(sourceDirectory);
+        const auto targetMetadata = FileEntry::readMetadata(targetDirectory);
+        if (sourceMetadata && targetMetadata && sameInode(*sourceMetadata, *targetMetadata)) {
+            return subdirectories;
+        }
+
+        std::vector<Listing> sourceListing;
+        std::vector<Listing> targetListing;
+        if (!listDirectory(sourceDirectory, sourceListing) || !listDirectory(targetDirectory, targetListing)) {
+            result.changed.push_back(relative);
+            return subdirectories;
+        }
+
+        auto sourceIt = sourceListing.begin();
+        auto targetIt = targetListing.begin();
+        while (sourceIt != sourceListing.end() || targetIt != targetListing.end()) {
+            if (targetIt == targetListing.end() || (sourceIt != sourceListing.end() && sourceIt->name < targetIt->name)) {
+                result.removed.push_back(relative / sourceIt->name);
+                ++sourceIt;
+                continue;
+            }
+            if (sourceIt == sourceListing.end() || targetIt->name < sourceIt->name) {
+                result.added.push_back(relative / targetIt->name);
+                ++targetIt;
+                continue;
+            }
+
+            const auto path = relative / sourceIt->name;
+            if (sourceIt->type != targetIt->type) {
+                result.changed.push_back(path);
+            } else if (sourceIt->type == std::filesystem::file_type::directory) {
+                subdirectories.push_back(path);
+            } else if (sourceIt->type == std::filesystem::file_type::regular) {
+                if (!sameFile(source / path, target / path, options.contentCheck)) {
+                    result.changed.push_back(path);
+                }
+            } else if (sourceIt->type == std::filesystem::file_type::symlink) {
+                if (!sameSymlink(source / path, target / path)) {
+                    result.changed.push_back(path);
+                }
+            }
+            ++sourceIt;
+            ++targetIt;
+        }
+
+        return subdirectories;
+    };
+
+    auto worker = [&]() {
+        DirectoryDiff local;
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            condition.wait(lock, [&] { return !pending.empty() || active == 0; });
+            if (pending.empty()) {
+                break;
+            }
+
+            const auto relative = std::move(pending.front());
+            pending.pop_front();
+            ++active;
+            lock.unlock();
+
+            auto subdirectories = compareDirectory(relative, local);
+
+            lock.lock();
+            --active;
+            for (auto& subdirectory : subdirectories) {
+                pending.push_back(std::move(subdirectory));
+            }
+            condition.notify_all();
+        }
+
+        for (const auto list : {&DirectoryDiff::added, &DirectoryDiff::removed, &DirectoryDiff::changed}) {
+            auto& from = local.*list;
+            auto& to = diff.*list;
+            to.insert(to.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < std::max(1u, options.maxParallel); ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto* list : {&diff.added, &diff.removed, &diff.changed}) {
+        std::sort(list->begin(), list->end());
+    }
+    return diff;
+}
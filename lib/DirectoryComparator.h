@@ -0,0 +1,52 @@
+//
+// DirectoryComparator.h
+// Tree-to-tree comparison of two directories
+//
+
+#ifndef DIRECTORYCOMPARATOR_H
+#define DIRECTORYCOMPARATOR_H
+
+#include <filesystem>
+#include <vector>
+
+// When to look at file contents for files present on both sides
+enum class ContentCheck {
+    Never,        // Size and modification time decide
+    WhenNeeded,   // Compare contents when sizes match but modification times differ
+    Always,       // Compare contents whenever sizes match
+};
+
+struct CompareOptions {
+    ContentCheck contentCheck = ContentCheck::WhenNeeded;
+    // Number of directory pairs compared concurrently
+    unsigned maxParallel = 4;
+};
+
+// Paths are relative to the compared roots and sorted. A directory present on one side
+// only is reported once, without its contents.
+struct DirectoryDiff {
+    std::vector<std::filesystem::path> added;     // Only in the target
+    std::vector<std::filesystem::path> removed;   // Only in the source
+    std::vector<std::filesystem::path> changed;   // In both, but different (or unreadable)
+
+    [[nodiscard]] bool identical() const {
+        return added.empty() && removed.empty() && changed.empty();
+    }
+};
+
+// Walks both trees in lockstep, one directory pair at a time, merging the sorted
+// listings of each pair. Subdirectory pairs are spread over worker threads.
+// Metadata is compared first and contents only when the options call for it.
+// Pairs that refer to the same inode on the same device (hard links, bind mounts,
+// comparing a tree with itself) are identical by definition and are not descended.
+class DirectoryComparator {
+public:
+    explicit DirectoryComparator(CompareOptions options = {});
+
+    [[nodiscard]] DirectoryDiff compare(const std::filesystem::path& source, const std::filesystem::path& target) const;
+
+private:
+    CompareOptions options;
+};
+
+#endif // DIRECTORYCOMPARATOR_H
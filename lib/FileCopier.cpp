@@ -0,0 +1,367 @@
+//
+// FileCopier.cpp
+// Bulk copy/sync of scanned file sets
+//
+
+#include "FileCopier.h"
+#include "FileEntryContainer.h"
+#include "IoThrottle.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#endif
+#endif
+
+namespace {
+
+// Largest request handed to a single copy_file_range/sendfile call
+constexpr size_t kCopyChunk = 1u << 30;
+
+// Request size when copying under a rate limit, so the limiter gets to pace the copy
+constexpr size_t kLimitedCopyChunk = 1u << 20;
+
+std::filesystem::path temporaryPath(const std::filesystem::path& destination) {
+    auto path = destination;
+    path += ".fsiltmp";
+    return path;
+}
+
+#ifndef _WIN32
+
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd) : fd(fd) {}
+    ~FileDescriptor() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    [[nodiscard]] int get() const { return fd; }
+
+private:
+    int fd;
+};
+
+std::runtime_error systemError(const std::string& what, const std::filesystem::path& path) {
+    return std::runtime_error(what + " " + path.string() + ": " + std::strerror(errno));
+}
+
+#ifdef __linux__
+// errno values meaning the mechanism is unavailable for this pair of files, rather than an I/O error
+bool isUnsupported(int error) {
+    return error == EXDEV || error == ENOSYS || error == EOPNOTSUPP || error == EINVAL;
+}
+#endif
+
+// Copies everything from in to out (both positioned at offset 0); returns the bytes written
+uintmax_t copyData(int in, int out, uintmax_t size, const std::filesystem::path& source, RateLimiter& limiter) {
+    uintmax_t copied = 0;
+    const size_t chunk = limiter.isLimited() ? kLimitedCopyChunk : kCopyChunk;
+
+#ifdef __linux__
+    // Shares the extents on copy-on-write filesystems; no data is moved at all
+    if (ioctl(out, FICLONE, in) == 0) {
+        return size;
+    }
+
+    bool supported = true;
+    for (;;) {
+        const ssize_t count = copy_file_range(in, nullptr, out, nullptr, chunk, 0);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (copied == 0 && isUnsupported(errno)) {
+                supported = false;
+                break;
+            }
+            throw systemError("Could not copy", source);
+        }
+        if (count == 0) {
+            break;
+        }
+        copied += static_cast<uintmax_t>(count);
+        limiter.acquire(static_cast<double>(count));
+    }
+    if (supported) {
+        return copied;
+    }
+
+    supported = true;
+    for (;;) {
+        const ssize_t count = sendfile(out, in, nullptr, chunk);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (copied == 0 && isUnsupported(errno)) {
+                supported = false;
+                break;
+            }
+            throw systemError("Could not copy", source);
+        }
+        if (count == 0) {
+            break;
+        }
+        copied += static_cast<uintmax_t>(count);
+        limiter.acquire(static_cast<double>(count));
+    }
+    if (supported) {
+        return copied;
+    }
+#endif
+
+    std::vector<char> buffer(kLimitedCopyChunk);
+    for (;;) {
+        const ssize_t count = ::read(in, buffer.data(), buffer.size());
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("Could not read", source);
+        }
+        if (count == 0) {
+            break;
+        }
+        for (ssize_t written = 0; written < count;) {
+            const ssize_t result = ::write(out, buffer.data() + written, static_cast<size_t>(count - written));
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw systemError("Could not write copy of", source);
+            }
+            written += result;
+        }
+        copied += static_cast<uintmax_t>(count);
+        limiter.acquire(static_cast<double>(count));
+    }
+    return copied;
+}
+
+#endif // _WIN32
+
+#ifndef _WIN32
+
+// Copies the data, then applies the permissions and, last, the modification time
+uintmax_t writeCopy(int in, int out, const FileMetadata& metadata, const std::filesystem::path& source,
+                    const std::filesystem::path& target, RateLimiter& limiter) {
+    const auto copied = copyData(in, out, metadata.size, source, limiter);
+    if (::fchmod(out, static_cast<mode_t>(metadata.permissions)) != 0) {
+        throw systemError("Could not set permissions on", target);
+    }
+
+    const auto sinceEpoch = FileEntry::toUnixTime(metadata.modificationTime);
+    const auto seconds = std::chrono::floor<std::chrono::seconds>(sinceEpoch);
+    struct timespec times[2] = {};
+    times[0].tv_nsec = UTIME_OMIT;
+    times[1].tv_sec = static_cast<time_t>(seconds.count());
+    times[1].tv_nsec = static_cast<long>((sinceEpoch - seconds).count());
+    if (::futimens(out, times) != 0) {
+        throw systemError("Could not set modification time on", target);
+    }
+    return copied;
+}
+
+#endif // _WIN32
+
+// A destination that is not known to exist is created in place (O_EXCL) and gets its
+// modification time last, so an interrupted copy is never taken for up to date. An
+// existing one is replaced through a temporary file renamed into place.
+uintmax_t copyWithMetadata(const std::filesystem::path& source, const std::filesystem::path& destination,
+                           const FileMetadata& metadata, RateLimiter& limiter, bool mayExist = true) {
+#ifdef _WIN32
+    (void)mayExist;
+    const auto temporary = temporaryPath(destination);
+    try {
+        std::filesystem::copy_file(source, temporary, std::filesystem::copy_options::overwrite_existing);
+        std::filesystem::permissions(temporary, metadata.permissions);
+        limiter.acquire(static_cast<double>(metadata.size));
+        std::filesystem::last_write_time(temporary, metadata.modificationTime);
+        std::filesystem::rename(temporary, destination);
+    } catch (...) {
+        std::error_code ec;
+        std::filesystem::remove(temporary, ec);
+        throw;
+    }
+    return metadata.size;
+#else
+    const FileDescriptor in(::open(source.c_str(), O_RDONLY | O_CLOEXEC));
+    if (in.get() < 0) {
+        throw systemError("Could not open file:", source);
+    }
+
+    if (!mayExist) {
+        const FileDescriptor out(::open(destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600));
+        if (out.get() >= 0) {
+            try {
+                return writeCopy(in.get(), out.get(), metadata, source, destination, limiter);
+            } catch (...) {
+                std::error_code ec;
+                std::filesystem::remove(destination, ec);
+                throw;
+            }
+        }
+        if (errno != EEXIST) {
+            throw systemError("Could not create file:", destination);
+        }
+    }
+
+    const auto temporary = temporaryPath(destination);
+    try {
+        const FileDescriptor out(::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600));
+        if (out.get() < 0) {
+            throw systemError("Could not create file:", temporary);
+        }
+        const auto copied = writeCopy(in.get(), out.get(), metadata, source, temporary, limiter);
+        std::filesystem::rename(temporary, destination);
+        return copied;
+    } catch (...) {
+        std::error_code ec;
+        std::filesystem::remove(temporary, ec);
+        throw;
+    }
+#endif
+}
+
+bool isUpToDate(const std::filesystem::path& source, const FileMetadata& sourceMetadata,
+                const std::filesystem::path& destination, const std::optional<FileMetadata>& target,
+                SkipPolicy policy) {
+    if (policy == SkipPolicy::Never) {
+        return false;
+    }
+    if (!target || target->type != std::filesystem::file_type::regular || target->size != sourceMetadata.size) {
+        return false;
+    }
+
+    if (policy == SkipPolicy::SizeAndModificationTime) {
+        return target->modificationTime == sourceMetadata.modificationTime;
+    }
+    return FileEntry(source).hasSameContent(FileEntry(destination));
+}
+
+} // namespace
+
+FileCopier::FileCopier(CopyOptions options) : options(std::move(options)) {
+}
+
+uintmax_t FileCopier::copyFile(const std::filesystem::path& source, const std::filesystem::path& destination) {
+    const auto metadata = FileEntry::readMetadata(source);
+    if (!metadata) {
+        throw std::runtime_error("File does not exist");
+    }
+    RateLimiter unlimited;
+    return copyWithMetadata(source, destination, *metadata, unlimited);
+}
+
+CopyStats FileCopier::copy(const FileEntryContainer& entries, const std::filesystem::path& sourceRoot,
+                           const std::filesystem::path& destinationRoot) const {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::filesystem::path> sources;
+    sources.reserve(entries.size());
+    entries.foreach([&sources](const FileEntry& entry) {
+        sources.push_back(entry.getPath());
+        return true;
+    });
+
+    std::mutex mutex;
+    CopyStats stats;
+    std::vector<std::string> errors;
+
+    // Updates the running totals and reports them
+    auto record = [&](const std::function<void(CopyStats&)>& update) {
+        std::lock_guard<std::mutex> lock(mutex);
+        update(stats);
+        stats.elapsed = std::chrono::steady_clock::now() - start;
+        if (options.progress) {
+            options.progress(stats);
+        }
+    };
+
+    // Parent directories that exist already, so each is created once per run
+    std::mutex directoryMutex;
+    std::unordered_set<std::string> directories;
+    auto createParent = [&](const std::filesystem::path& destination) {
+        const auto parent = destination.parent_path();
+        std::lock_guard<std::mutex> lock(directoryMutex);
+        if (directories.count(parent.string()) == 0) {
+            std::filesystem::create_directories(parent);
+            directories.insert(parent.string());
+        }
+    };
+
+    RateLimiter limiter(options.maxBytesPerSecond);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        const IoPriorityGuard priority(options.idlePriority);
+        for (size_t i = next++; i < sources.size(); i = next++) {
+            const auto& source = sources[i];
+            try {
+                const auto relative = source.lexically_relative(sourceRoot);
+                if (relative.empty() || *relative.begin() == "..") {
+                    throw std::runtime_error("Not below the source root");
+                }
+                const auto destination = destinationRoot / relative;
+
+                const auto metadata = FileEntry::readMetadata(source);
+                if (!metadata) {
+                    throw std::runtime_error("File does not exist");
+                }
+                // Without a skip policy the target is not stat'ed; creating it in place falls back on EEXIST
+                const auto target = options.skipPolicy == SkipPolicy::Never ? std::nullopt
+                                                                            : FileEntry::readMetadata(destination);
+                if (isUpToDate(source, *metadata, destination, target, options.skipPolicy)) {
+                    record([](CopyStats& s) { ++s.filesSkipped; });
+                    continue;
+                }
+
+                createParent(destination);
+                const auto bytes = copyWithMetadata(source, destination, *metadata, limiter, target.has_value());
+                record([bytes](CopyStats& s) {
+                    ++s.filesCopied;
+                    s.bytesCopied += bytes;
+                });
+            } catch (const std::exception& e) {
+                const std::string message = source.string() + ": " + e.what();
+                record([&errors, &message](CopyStats& s) {
+                    ++s.filesFailed;
+                    errors.push_back(message);
+                });
+            }
+        }
+    };
+
+    const size_t threadCount = std::min<size_t>(std::max(1u, options.maxParallel), sources.size());
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    stats.elapsed = std::chrono::steady_clock::now() - start;
+    stats.errors = std::move(errors);
+    return stats;
+}
@@ -0,0 +1,73 @@
+//
+// FileCopier.h
+// Bulk copy/sync of scanned file sets
+//
+
+#ifndef FILECOPIER_H
+#define FILECOPIER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+class FileEntryContainer;
+
+// How to decide that an existing target is already up to date
+enum class SkipPolicy {
+    Never,                       // Always copy
+    SizeAndModificationTime,     // Same size and modification time
+    Content,                     // Same size and identical bytes
+};
+
+struct CopyStats {
+    size_t filesCopied = 0;
+    size_t filesSkipped = 0;
+    size_t filesFailed = 0;
+    uintmax_t bytesCopied = 0;
+    std::chrono::duration<double> elapsed{};
+    // One message per failed file; only filled in the final result
+    std::vector<std::string> errors;
+
+    [[nodiscard]] double bytesPerSecond() const {
+        return elapsed.count() > 0 ? static_cast<double>(bytesCopied) / elapsed.count() : 0.0;
+    }
+};
+
+struct CopyOptions {
+    SkipPolicy skipPolicy = SkipPolicy::SizeAndModificationTime;
+    // Number of files copied concurrently
+    unsigned maxParallel = 4;
+    // Token bucket limit on bytes copied per second across all workers; 0 is unlimited.
+    // Reflinked files move no data and are not charged.
+    double maxBytesPerSecond = 0;
+    // Run the workers in the idle I/O scheduling class (Linux)
+    bool idlePriority = false;
+    // Called after every file with the running totals (serialised, but from worker threads)
+    std::function<void(const CopyStats&)> progress;
+};
+
+// Copies files below sourceRoot to the same relative location below destinationRoot.
+// Data is moved inside the kernel where possible: a reflink (FICLONE) first, then
+// copy_file_range, then sendfile, and a read/write loop as the last resort. The
+// source permissions and modification time are applied through the open file, the
+// time last. New targets are created in place; existing ones are written to a
+// temporary name and renamed into place once complete.
+class FileCopier {
+public:
+    explicit FileCopier(CopyOptions options = {});
+
+    CopyStats copy(const FileEntryContainer& entries, const std::filesystem::path& sourceRoot,
+                   const std::filesystem::path& destinationRoot) const;
+
+    // Copies a single file; returns the number of bytes written
+    static uintmax_t copyFile(const std::filesystem::path& source, const std::filesystem::path& destination);
+
+private:
+    CopyOptions options;
+};
+
+#endif // FILECOPIER_H
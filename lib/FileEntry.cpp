@@ -5,6 +5,7 @@
 #include "FileEntry.h"
 
 #include <utility>
+#include <cstring>
 #include <exception>
 #include <fstream>
 
@@ -64,6 +65,18 @@ std::filesystem::path FileEntry::getExtension() const {
 }
 
 std::string FileEntry::getContent() const {
+    auto stream = openContent();
+
+    std::string contents;
+    std::string buffer(64 * 1024, '\0');
+    while (const size_t count = stream->read(buffer.data(), buffer.size())) {
+        contents.append(buffer.data(), count);
+    }
+
+    return contents;
+}
+
+std::string FileEntry::getRawContent() const {
     if (std::filesystem::exists(filePath)) {
         std::ifstream file(filePath, std::ios::in | std::ios::binary); // Open file in binary mode
         if (!file.is_open()) {
@@ -79,15 +92,70 @@ std::string FileEntry::getContent() const {
     throw std::runtime_error("File does not exist");
 }
 
+bool FileEntry::hasSameContent(const FileEntry &other) const {
+    std::ifstream first(filePath, std::ios::in | std::ios::binary);
+    std::ifstream second(other.filePath, std::ios::in | std::ios::binary);
+    if (!first.is_open() || !second.is_open()) {
+        throw std::runtime_error("Could not open file for comparison");
+    }
+
+    std::string firstBuffer(64 * 1024, '\0');
+    std::string secondBuffer(64 * 1024, '\0');
+    for (;;) {
+        first.read(firstBuffer.data(), static_cast<std::streamsize>(firstBuffer.size()));
+        second.read(secondBuffer.data(), static_cast<std::streamsize>(secondBuffer.size()));
+        const auto firstCount = first.gcount();
+        if (firstCount != second.gcount() ||
+            std::memcmp(firstBuffer.data(), secondBuffer.data(), static_cast<size_t>(firstCount)) != 0) {
+            return false;
+        }
+        if (firstCount == 0) {
+            return true;
+        }
+    }
+}
+
+ContentStreamPtr FileEntry::openContent(unsigned threads) const {
+    if (std::filesystem::exists(filePath)) {
+        return ContentStream::open(filePath, threads);
+    }
+    throw std::runtime_error("File does not exist");
+}
+
+bool FileEntry::forEachLine(const std::function<bool(const std::string &)> &callback) const {
+    auto stream = openContent();
+
+    std::string buffer(64 * 1024, '\0');
+    std::string line;
+    while (const size_t count = stream->read(buffer.data(), buffer.size())) {
+        const char* position = buffer.data();
+        const char* end = buffer.data() + count;
+
+        while (const auto* newline = static_cast<const char*>(std::memchr(position, '\n', end - position))) {
+            line.append(position, newline);
+            if (!callback(line)) {
+                return false;
+            }
+            line.clear();
+            position = newline + 1;
+        }
+        line.append(position, end);
+    }
+
+    // Same as std::getline: a trailing newline does not start another line
+    if (!line.empty()) {
+        return callback(line);
+    }
+    return true;
+}
+
 std::vector<std::string> FileEntry::getLines() const {
     std::vector<std::string> lines;
-    std::string content = getContent();
-    std::istringstream contentStream(content);
-    std::string line;
 
-    while (std::getline(contentStream, line)) {
+    forEachLine([&lines](const std::string& line) {
         lines.push_back(line);
-    }
+        return true;
+    });
 
     return lines;
 }
@@ -145,6 +213,84 @@ std::filesystem::file_time_type FileEntry::getLastAccessTime() const {
 }
 
 
+FileMetadata FileEntry::getMetadata() const {
+    if (auto metadata = readMetadata(filePath)) {
+        return *metadata;
+    }
+    throw std::runtime_error("File does not exist");
+}
+
+#ifdef _WIN32
+std::optional<FileMetadata> FileEntry::readMetadata(const std::filesystem::path& path) {
+    std::error_code ec;
+    const auto status = std::filesystem::status(path, ec);
+    if (ec || !std::filesystem::exists(status)) {
+        return std::nullopt;
+    }
+
+    FileMetadata metadata;
+    metadata.type = status.type();
+    metadata.permissions = status.permissions();
+    metadata.modificationTime = std::filesystem::last_write_time(path, ec);
+    if (metadata.type == std::filesystem::file_type::regular) {
+        metadata.size = std::filesystem::file_size(path, ec);
+    }
+    return metadata;
+}
+#else
+namespace {
+
+// Offset between the filesystem clock and the system clock. Standard libraries use a
+// whole number of seconds here, so rounding removes the jitter between the two now() calls.
+std::filesystem::file_time_type::duration fileClockOffset() {
+    static const auto offset = [] {
+        const auto fileNow = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::filesystem::file_time_type::clock::now().time_since_epoch());
+        const auto systemNow = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch());
+        return std::chrono::duration_cast<std::filesystem::file_time_type::duration>(
+                std::chrono::round<std::chrono::seconds>(fileNow - systemNow));
+    }();
+    return offset;
+}
+
+std::filesystem::file_type fileTypeFromMode(mode_t mode) {
+    if (S_ISREG(mode)) return std::filesystem::file_type::regular;
+    if (S_ISDIR(mode)) return std::filesystem::file_type::directory;
+    if (S_ISLNK(mode)) return std::filesystem::file_type::symlink;
+    if (S_ISBLK(mode)) return std::filesystem::file_type::block;
+    if (S_ISCHR(mode)) return std::filesystem::file_type::character;
+    if (S_ISFIFO(mode)) return std::filesystem::file_type::fifo;
+    if (S_ISSOCK(mode)) return std::filesystem::file_type::socket;
+    return std::filesystem::file_type::unknown;
+}
+
+} // namespace
+
+std::optional<FileMetadata> FileEntry::readMetadata(const std::filesystem::path& path) {
+    struct stat fileStat{};
+    if (stat(path.c_str(), &fileStat) != 0) {
+        return std::nullopt;
+    }
+
+    const auto sinceEpoch = std::chrono::seconds(fileStat.st_mtim.tv_sec) + std::chrono::nanoseconds(fileStat.st_mtim.tv_nsec);
+
+    FileMetadata metadata;
+    metadata.size = static_cast<uintmax_t>(fileStat.st_size);
+    metadata.modificationTime = std::filesystem::file_time_type(
+            std::chrono::duration_cast<std::filesystem::file_time_type::duration>(sinceEpoch) + fileClockOffset());
+    metadata.permissions = static_cast<std::filesystem::perms>(fileStat.st_mode & 07777);
+    metadata.type = fileTypeFromMode(fileStat.st_mode);
+    metadata.device = static_cast<uint64_t>(fileStat.st_dev);
+    metadata.inode = static_cast<uint64_t>(fileStat.st_ino);
+    return metadata;
+}
+
+std::chrono::nanoseconds FileEntry::toUnixTime(const std::filesystem::file_time_type& time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch() - fileClockOffset());
+}
+#endif
+
 std::string FileEntry::fileTimeToString(const std::filesystem::file_time_type& time) {
     // Convert std::filesystem::file_time_type to system_clock::time_point
     auto systemTimePoint = std::chrono::system_clock::now() +
@@ -5,7 +5,14 @@
 #ifndef FILEENTRY_H
 #define FILEENTRY_H
 
+#include "ContentStream.h"
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 class FileEntry;
@@ -13,6 +20,15 @@ class FileEntry;
 using FileEntryPtr = std::unique_ptr<FileEntry>;
 using FileEntryVec = std::vector<FileEntryPtr>;
 
+// Metadata gathered by a single stat of a file (symlinks are followed)
+struct FileMetadata {
+    uintmax_t size = 0;
+    std::filesystem::file_time_type modificationTime{};
+    std::filesystem::perms permissions = std::filesystem::perms::unknown;
+    std::filesystem::file_type type = std::filesystem::file_type::none;
+    uint64_t device = 0;
+    uint64_t inode = 0;
+};
 
 class FileEntry {
 public:
@@ -37,10 +53,27 @@ public:
     [[nodiscard]] std::filesystem::file_time_type getCreationTime() const;
     [[nodiscard]] std::filesystem::file_time_type getLastAccessTime() const;
 
+    [[nodiscard]] FileMetadata getMetadata() const;
+    // Non-throwing variant; empty if the path cannot be stat'ed
+    [[nodiscard]] static std::optional<FileMetadata> readMetadata(const std::filesystem::path& path);
+#ifndef _WIN32
+    // Time since the Unix epoch, as taken by futimens/utimensat
+    [[nodiscard]] static std::chrono::nanoseconds toUnixTime(const std::filesystem::file_time_type& time);
+#endif
+
     [[nodiscard]] static std::string fileTimeToString(const std::filesystem::file_time_type& time);
 
+    // Content accessors decompress gzip/BGZF/zstd files transparently (see ContentStream)
     [[nodiscard]] std::string getContent() const;
     [[nodiscard]] std::vector<std::string> getLines() const;
+    [[nodiscard]] ContentStreamPtr openContent(unsigned threads = 0) const;
+    // Streams the lines one at a time; returns false if the callback stopped the iteration
+    bool forEachLine(const std::function<bool(const std::string&)>& callback) const;
+
+    // The bytes as stored on disk, without decompression
+    [[nodiscard]] std::string getRawContent() const;
+    // Byte-for-byte comparison of the stored bytes, stopping at the first difference
+    [[nodiscard]] bool hasSameContent(const FileEntry& other) const;
 
     static FileEntryPtr newEntry(const std::filesystem::path& path);
 
@@ -8,6 +8,7 @@
 
 FileEntryContainer::FileEntryContainer(FileEntryContainer &&other) noexcept {
     fileEntries = std::move(other.fileEntries);
+    index = std::move(other.index);
 }
 //
 FileEntryContainer::FileEntryContainer(std::initializer_list<FileEntry> entries) {
@@ -20,6 +21,13 @@ FileEntryPtr &FileEntryContainer::operator[](int index) {
     return fileEntries[index];
 }
 
+void FileEntryContainer::replace(size_t position, const FileEntry &entry) {
+    auto replacement = FileEntry::newEntry(entry.getPath());
+    index.remove(*fileEntries.at(position));
+    fileEntries[position] = std::move(replacement);
+    index.add(*fileEntries[position]);
+}
+
 FileEntry &FileEntryContainer::operator[](size_t index) const {
     return *fileEntries[index].get();
 }
@@ -40,14 +48,81 @@ size_t FileEntryContainer::size() const {
 
 void FileEntryContainer::append(const std::filesystem::path& path) {
     fileEntries.emplace_back(FileEntry::newEntry(path));
+    index.add(*fileEntries.back());
 }
 
 void FileEntryContainer::append(const FileEntry &entry) {
     fileEntries.emplace_back(FileEntry::newEntry(entry.getPath()));
+    index.add(*fileEntries.back());
 }
 
 void FileEntryContainer::sortFileEntriesAlphabetically() {
     std::sort(fileEntries.begin(), fileEntries.end(), [](const FileEntryPtr& a, const FileEntryPtr& b) {
         return a->getPath().string() < b->getPath().string();
     });
-}
\ No newline at end of file
+}
+
+void FileEntryContainer::enableIndex(IndexType type) {
+    index.enable(type, fileEntries);
+}
+
+void FileEntryContainer::disableIndex(IndexType type) {
+    index.disable(type);
+}
+
+bool FileEntryContainer::hasIndex(IndexType type) const {
+    return index.isEnabled(type);
+}
+
+void FileEntryContainer::rebuildIndexes() {
+    index.rebuild(fileEntries);
+}
+
+FileEntryView<uintmax_t> FileEntryContainer::findBySize(uintmax_t minSize, uintmax_t maxSize) const {
+    return index.findBySize(minSize, maxSize);
+}
+
+FileEntryView<std::filesystem::file_time_type> FileEntryContainer::findByModificationTime(
+        std::filesystem::file_time_type from, std::filesystem::file_time_type to) const {
+    return index.findByModificationTime(from, to);
+}
+
+FileEntryView<std::string> FileEntryContainer::findByExtension(const std::string &extension) const {
+    return index.findByExtension(extension);
+}
+
+FileEntryView<std::string> FileEntryContainer::findByNamePrefix(const std::string &prefix) const {
+    return index.findByNamePrefix(prefix);
+}
+
+CopyStats FileEntryContainer::copyTo(const std::filesystem::path &sourceRoot, const std::filesystem::path &destinationRoot,
+                                     const CopyOptions &options) const {
+    return FileCopier(options).copy(*this, sourceRoot, destinationRoot);
+}
+
+std::vector<const FileEntry *> FileEntryContainer::accessOrder(AccessOrder order) const {
+    return AccessPlanner::plan(fileEntries, order);
+}
+
+bool FileEntryContainer::fetchMetadata(const std::function<bool(const FileEntry &, const FileMetadata &)> &callback,
+                                       AccessOrder order) const {
+    for (const auto* entry : accessOrder(order)) {
+        const auto metadata = FileEntry::readMetadata(entry->getPath());
+        if (metadata && !callback(*entry, *metadata)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool FileEntryContainer::readContents(const std::function<bool(const FileEntry &, const std::string &)> &callback,
+                                      AccessOrder order) const {
+    for (const auto* entry : accessOrder(order)) {
+        if (!callback(*entry, entry->getContent())) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -6,6 +6,9 @@
 #define FILEENTRYCONTAINER_H
 
 #include "FileEntry.h"
+#include "FileEntryIndex.h"
+#include "FileCopier.h"
+#include "AccessPlanner.h"
 #include <filesystem>
 #include <functional>
 
@@ -15,7 +18,11 @@ public:
      FileEntryContainer(FileEntryContainer&& other) noexcept ;
      FileEntryContainer(std::initializer_list<FileEntry> entries);
 //
+     // Replacing the pointer through this reference bypasses the indexes, which keep pointing
+     // at the old entry: use replace() instead, or call rebuildIndexes() right after.
      FileEntryPtr &operator[](int index);
+     // Puts a copy of entry at index and updates the enabled indexes
+     void replace(std::size_t index, const FileEntry& entry);
 
      void append(const FileEntry& entry);
      void append(const std::filesystem::path& path);
@@ -25,9 +32,38 @@ public:
      void sortFileEntriesAlphabetically();
 
      bool foreach(const std::function<bool(const FileEntry&)>& callback) const;
+
+     // Optional secondary indexes, built once and kept up to date on append.
+     // Metadata is captured when an entry is indexed; call rebuildIndexes() after files change.
+     void enableIndex(IndexType type);
+     void disableIndex(IndexType type);
+     bool hasIndex(IndexType type) const;
+     void rebuildIndexes();
+
+     // Range and equality queries over enabled indexes (inclusive ranges, O(log n + k))
+     FileEntryView<uintmax_t> findBySize(uintmax_t minSize, uintmax_t maxSize) const;
+     FileEntryView<std::filesystem::file_time_type> findByModificationTime(std::filesystem::file_time_type from,
+                                                                           std::filesystem::file_time_type to) const;
+     FileEntryView<std::string> findByExtension(const std::string& extension) const;
+     FileEntryView<std::string> findByNamePrefix(const std::string& prefix) const;
+
+     // The entries in the order a batch operation would visit them (see AccessPlanner)
+     std::vector<const FileEntry*> accessOrder(AccessOrder order) const;
+     // Batch metadata: one stat per entry, issued in the given order. Entries that cannot be
+     // stat'ed are skipped. Returns false if the callback stopped the iteration.
+     bool fetchMetadata(const std::function<bool(const FileEntry&, const FileMetadata&)>& callback,
+                        AccessOrder order = AccessOrder::Inode) const;
+     // Bulk read of the (decompressed) contents in the given order
+     bool readContents(const std::function<bool(const FileEntry&, const std::string&)>& callback,
+                       AccessOrder order = AccessOrder::PhysicalOffset) const;
+
+     // Copies the entries below sourceRoot to the same relative paths below destinationRoot (see FileCopier)
+     CopyStats copyTo(const std::filesystem::path& sourceRoot, const std::filesystem::path& destinationRoot,
+                      const CopyOptions& options = {}) const;
 //
 private:
      FileEntryVec fileEntries;
+     FileEntryIndex index;
 };
 
 
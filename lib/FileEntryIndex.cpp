@@ -0,0 +1,157 @@
+//
+// FileEntryIndex.cpp
+// Sorted secondary indexes over the entries of a FileEntryContainer
+//
+
+#include "FileEntryIndex.h"
+
+#include <stdexcept>
+
+namespace {
+
+template <typename Map>
+const Map& requireIndex(const std::optional<Map>& index) {
+    if (!index) {
+        throw std::runtime_error("Index is not enabled");
+    }
+    return *index;
+}
+
+} // namespace
+
+void FileEntryIndex::enable(IndexType type, const FileEntryVec& entries) {
+    if (isEnabled(type)) {
+        return;
+    }
+
+    switch (type) {
+        case IndexType::Size: bySize.emplace(); break;
+        case IndexType::ModificationTime: byModificationTime.emplace(); break;
+        case IndexType::Extension: byExtension.emplace(); break;
+        case IndexType::NamePrefix: byName.emplace(); break;
+    }
+
+    for (const auto& entry : entries) {
+        add(type, *entry);
+    }
+}
+
+void FileEntryIndex::disable(IndexType type) {
+    switch (type) {
+        case IndexType::Size: bySize.reset(); break;
+        case IndexType::ModificationTime: byModificationTime.reset(); break;
+        case IndexType::Extension: byExtension.reset(); break;
+        case IndexType::NamePrefix: byName.reset(); break;
+    }
+}
+
+bool FileEntryIndex::isEnabled(IndexType type) const {
+    switch (type) {
+        case IndexType::Size: return bySize.has_value();
+        case IndexType::ModificationTime: return byModificationTime.has_value();
+        case IndexType::Extension: return byExtension.has_value();
+        case IndexType::NamePrefix: return byName.has_value();
+    }
+    return false;
+}
+
+void FileEntryIndex::add(const FileEntry& entry) {
+    for (auto type : {IndexType::Size, IndexType::ModificationTime, IndexType::Extension, IndexType::NamePrefix}) {
+        if (isEnabled(type)) {
+            add(type, entry);
+        }
+    }
+}
+
+void FileEntryIndex::remove(const FileEntry& entry) {
+    const auto erase = [&entry](auto& index) {
+        if (!index) {
+            return;
+        }
+        for (auto it = index->begin(); it != index->end();) {
+            it = it->second == &entry ? index->erase(it) : std::next(it);
+        }
+    };
+    erase(bySize);
+    erase(byModificationTime);
+    erase(byExtension);
+    erase(byName);
+}
+
+void FileEntryIndex::rebuild(const FileEntryVec& entries) {
+    for (auto type : {IndexType::Size, IndexType::ModificationTime, IndexType::Extension, IndexType::NamePrefix}) {
+        if (isEnabled(type)) {
+            disable(type);
+            enable(type, entries);
+        }
+    }
+}
+
+// Entries whose metadata cannot be read (e.g. the file is missing) are left out of
+// the size and modification time indexes.
+void FileEntryIndex::add(IndexType type, const FileEntry& entry) {
+    const auto& path = entry.getPath();
+    std::error_code ec;
+
+    switch (type) {
+        case IndexType::Size: {
+            const auto size = std::filesystem::file_size(path, ec);
+            if (!ec) {
+                bySize->emplace(size, &entry);
+            }
+            break;
+        }
+        case IndexType::ModificationTime: {
+            const auto time = std::filesystem::last_write_time(path, ec);
+            if (!ec) {
+                byModificationTime->emplace(time, &entry);
+            }
+            break;
+        }
+        case IndexType::Extension:
+            byExtension->emplace(path.extension().string(), &entry);
+            break;
+        case IndexType::NamePrefix:
+            byName->emplace(path.filename().string(), &entry);
+            break;
+    }
+}
+
+FileEntryView<uintmax_t> FileEntryIndex::findBySize(uintmax_t minSize, uintmax_t maxSize) const {
+    const auto& index = requireIndex(bySize);
+    if (minSize > maxSize) {
+        return {index.end(), index.end()};
+    }
+    return {index.lower_bound(minSize), index.upper_bound(maxSize)};
+}
+
+FileEntryView<std::filesystem::file_time_type> FileEntryIndex::findByModificationTime(
+        std::filesystem::file_time_type from, std::filesystem::file_time_type to) const {
+    const auto& index = requireIndex(byModificationTime);
+    if (from > to) {
+        return {index.end(), index.end()};
+    }
+    return {index.lower_bound(from), index.upper_bound(to)};
+}
+
+FileEntryView<std::string> FileEntryIndex::findByExtension(const std::string& extension) const {
+    const auto& index = requireIndex(byExtension);
+    const auto range = index.equal_range(extension);
+    return {range.first, range.second};
+}
+
+FileEntryView<std::string> FileEntryIndex::findByNamePrefix(const std::string& prefix) const {
+    const auto& index = requireIndex(byName);
+    const auto first = index.lower_bound(prefix);
+
+    // The range ends at the smallest key greater than every key starting with prefix
+    std::string next = prefix;
+    while (!next.empty() && static_cast<unsigned char>(next.back()) == 0xFF) {
+        next.pop_back();
+    }
+    if (next.empty()) {
+        return {first, index.end()};
+    }
+    next.back() = static_cast<char>(static_cast<unsigned char>(next.back()) + 1);
+    return {first, index.lower_bound(next)};
+}
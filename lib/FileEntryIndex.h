@@ -0,0 +1,100 @@
+//
+// FileEntryIndex.h
+// Sorted secondary indexes over the entries of a FileEntryContainer
+//
+
+#ifndef FILEENTRYINDEX_H
+#define FILEENTRYINDEX_H
+
+#include "FileEntry.h"
+#include <cstddef>
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <string>
+
+enum class IndexType {
+    Size,
+    ModificationTime,
+    Extension,
+    NamePrefix,
+};
+
+// Lightweight view over a range of an index. Yields the indexed entries in key order
+// without copying them; it stays valid until the owning container is modified.
+template <typename Key>
+class FileEntryView {
+public:
+    using MapType = std::multimap<Key, const FileEntry*>;
+    using BaseIterator = typename MapType::const_iterator;
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FileEntry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const FileEntry*;
+        using reference = const FileEntry&;
+
+        iterator() = default;
+        explicit iterator(BaseIterator it) : it(it) {}
+
+        reference operator*() const { return *it->second; }
+        pointer operator->() const { return it->second; }
+        [[nodiscard]] const Key& key() const { return it->first; }
+
+        iterator& operator++() { ++it; return *this; }
+        iterator operator++(int) { iterator tmp = *this; ++it; return tmp; }
+
+        bool operator==(const iterator& other) const { return it == other.it; }
+        bool operator!=(const iterator& other) const { return it != other.it; }
+
+    private:
+        BaseIterator it;
+    };
+
+    FileEntryView() = default;
+    FileEntryView(BaseIterator first, BaseIterator last) : first(first), last(last) {}
+
+    [[nodiscard]] iterator begin() const { return iterator(first); }
+    [[nodiscard]] iterator end() const { return iterator(last); }
+    [[nodiscard]] bool empty() const { return first == last; }
+    [[nodiscard]] size_t size() const { return static_cast<size_t>(std::distance(first, last)); }
+
+private:
+    BaseIterator first{};
+    BaseIterator last{};
+};
+
+// Holds the enabled indexes. Entries are referenced by pointer, which stays stable
+// while the owning container grows or is sorted.
+class FileEntryIndex {
+public:
+    void enable(IndexType type, const FileEntryVec& entries);
+    void disable(IndexType type);
+    [[nodiscard]] bool isEnabled(IndexType type) const;
+
+    void add(const FileEntry& entry);
+    // Drops every reference to entry; linear in the size of the enabled indexes
+    void remove(const FileEntry& entry);
+    void rebuild(const FileEntryVec& entries);
+
+    // Inclusive ranges
+    [[nodiscard]] FileEntryView<uintmax_t> findBySize(uintmax_t minSize, uintmax_t maxSize) const;
+    [[nodiscard]] FileEntryView<std::filesystem::file_time_type> findByModificationTime(
+            std::filesystem::file_time_type from, std::filesystem::file_time_type to) const;
+
+    [[nodiscard]] FileEntryView<std::string> findByExtension(const std::string& extension) const;
+    [[nodiscard]] FileEntryView<std::string> findByNamePrefix(const std::string& prefix) const;
+
+private:
+    void add(IndexType type, const FileEntry& entry);
+
+    std::optional<std::multimap<uintmax_t, const FileEntry*>> bySize;
+    std::optional<std::multimap<std::filesystem::file_time_type, const FileEntry*>> byModificationTime;
+    std::optional<std::multimap<std::string, const FileEntry*>> byExtension;
+    std::optional<std::multimap<std::string, const FileEntry*>> byName;
+};
+
+#endif // FILEENTRYINDEX_H
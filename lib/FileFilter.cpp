@@ -0,0 +1,61 @@
+//
+// FileFilter.cpp
+// Composable filter predicates for FileScanner
+//
+
+#include "FileFilter.h"
+#include "FileEntry.h"
+
+namespace FileFilter {
+
+void Candidate::fetch() const {
+    if (fetched) {
+        return;
+    }
+    fetched = true;
+    if (const auto metadata = FileEntry::readMetadata(entry.path())) {
+        cachedSize = metadata->size;
+        cachedModificationTime = metadata->modificationTime;
+    }
+}
+
+std::optional<uintmax_t> Candidate::size() const {
+    fetch();
+    return cachedSize;
+}
+
+std::optional<std::filesystem::file_time_type> Candidate::modificationTime() const {
+    fetch();
+    return cachedModificationTime;
+}
+
+bool globMatch(std::string_view pattern, std::string_view text) {
+    size_t p = 0;
+    size_t t = 0;
+    size_t starPattern = std::string_view::npos;
+    size_t starText = 0;
+
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            // Remember the star and try matching it against nothing first
+            starPattern = p++;
+            starText = t;
+        } else if (starPattern != std::string_view::npos) {
+            // Let the last star swallow one more character
+            p = starPattern + 1;
+            t = ++starText;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+} // namespace FileFilter
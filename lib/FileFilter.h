@@ -0,0 +1,286 @@
+//
+// FileFilter.h
+// Composable filter predicates for FileScanner
+//
+
+#ifndef FILEFILTER_H
+#define FILEFILTER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Predicates are combined with &&, || and ! into a single expression type, e.g.
+//
+//     using namespace FileFilter;
+//     using namespace FileFilter::literals;
+//     scanner.scan(dir, entries, ext(".log") && size_gt(1_MB) && !name_glob("*.tmp"), true);
+//
+// Every clause declares the metadata it needs. Conjunctions and disjunctions
+// evaluate their cheaper side first, so name-only clauses run before any stat,
+// and size/modification time are only fetched (by one stat) when a clause asks.
+// A file whose metadata was needed but could not be read is rejected, even if
+// the clause that asked for it is negated.
+namespace FileFilter {
+
+// Metadata a clause needs before it can be evaluated
+enum Need : unsigned {
+    NeedNothing = 0,
+    NeedSize = 1u << 0,
+    NeedModificationTime = 1u << 1,
+};
+
+// Number of stat calls needed to evaluate a clause; size and modification time come from the same one
+constexpr unsigned cost(unsigned needs) {
+    return (needs & (NeedSize | NeedModificationTime)) ? 1u : 0u;
+}
+
+// A directory entry under test. Metadata is fetched by one stat on first use and cached.
+class Candidate {
+public:
+    explicit Candidate(const std::filesystem::directory_entry& entry) : entry(entry) {}
+
+    [[nodiscard]] const std::filesystem::path& path() const { return entry.path(); }
+    [[nodiscard]] std::optional<uintmax_t> size() const;
+    [[nodiscard]] std::optional<std::filesystem::file_time_type> modificationTime() const;
+
+    // Metadata was asked for and could not be read
+    [[nodiscard]] bool metadataUnknown() const { return fetched && !cachedSize; }
+
+private:
+    void fetch() const;
+
+    const std::filesystem::directory_entry& entry;
+    mutable std::optional<uintmax_t> cachedSize;
+    mutable std::optional<std::filesystem::file_time_type> cachedModificationTime;
+    mutable bool fetched = false;
+};
+
+// Shell-style wildcard match supporting '*' and '?'
+[[nodiscard]] bool globMatch(std::string_view pattern, std::string_view text);
+
+struct ExpressionTag {};
+
+// CRTP base for all filter expressions
+template <typename Derived>
+class Expression : public ExpressionTag {
+public:
+    [[nodiscard]] const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+    bool operator()(const std::filesystem::directory_entry& entry) const {
+        const Candidate candidate(entry);
+        // Checked after the test: a negated metadata clause must not let an unreadable file through
+        return derived().test(candidate) && !candidate.metadataUnknown();
+    }
+
+    bool operator()(const std::filesystem::path& path) const {
+        // A missing file still has a name; metadata clauses simply fail on it
+        std::error_code ec;
+        std::filesystem::directory_entry entry;
+        entry.assign(path, ec);
+        return (*this)(entry);
+    }
+};
+
+template <typename T>
+inline constexpr bool isExpression = std::is_base_of_v<ExpressionTag, std::decay_t<T>>;
+
+template <typename L, typename R>
+class And : public Expression<And<L, R>> {
+public:
+    static constexpr unsigned needs = L::needs | R::needs;
+
+    And(L lhs, R rhs) : lhs(std::move(lhs)), rhs(std::move(rhs)) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        if constexpr (cost(R::needs) < cost(L::needs)) {
+            return rhs.test(candidate) && lhs.test(candidate);
+        } else {
+            return lhs.test(candidate) && rhs.test(candidate);
+        }
+    }
+
+private:
+    L lhs;
+    R rhs;
+};
+
+template <typename L, typename R>
+class Or : public Expression<Or<L, R>> {
+public:
+    static constexpr unsigned needs = L::needs | R::needs;
+
+    Or(L lhs, R rhs) : lhs(std::move(lhs)), rhs(std::move(rhs)) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        if constexpr (cost(R::needs) < cost(L::needs)) {
+            return rhs.test(candidate) || lhs.test(candidate);
+        } else {
+            return lhs.test(candidate) || rhs.test(candidate);
+        }
+    }
+
+private:
+    L lhs;
+    R rhs;
+};
+
+template <typename E>
+class Not : public Expression<Not<E>> {
+public:
+    static constexpr unsigned needs = E::needs;
+
+    explicit Not(E expr) : expr(std::move(expr)) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        return !expr.test(candidate);
+    }
+
+private:
+    E expr;
+};
+
+template <typename L, typename R>
+And<L, R> operator&&(const Expression<L>& lhs, const Expression<R>& rhs) {
+    return And<L, R>(lhs.derived(), rhs.derived());
+}
+
+template <typename L, typename R>
+Or<L, R> operator||(const Expression<L>& lhs, const Expression<R>& rhs) {
+    return Or<L, R>(lhs.derived(), rhs.derived());
+}
+
+template <typename E>
+Not<E> operator!(const Expression<E>& expr) {
+    return Not<E>(expr.derived());
+}
+
+// Clauses
+
+class Extension : public Expression<Extension> {
+public:
+    static constexpr unsigned needs = NeedNothing;
+
+    explicit Extension(std::string extension) : extension(std::move(extension)) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        return candidate.path().extension() == extension;
+    }
+
+private:
+    std::string extension;
+};
+
+class NameGlob : public Expression<NameGlob> {
+public:
+    static constexpr unsigned needs = NeedNothing;
+
+    explicit NameGlob(std::string pattern) : pattern(std::move(pattern)) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        return globMatch(pattern, candidate.path().filename().string());
+    }
+
+private:
+    std::string pattern;
+};
+
+class SizeGreater : public Expression<SizeGreater> {
+public:
+    static constexpr unsigned needs = NeedSize;
+
+    explicit SizeGreater(uintmax_t bytes) : bytes(bytes) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        const auto size = candidate.size();
+        return size && *size > bytes;
+    }
+
+private:
+    uintmax_t bytes;
+};
+
+class SizeLess : public Expression<SizeLess> {
+public:
+    static constexpr unsigned needs = NeedSize;
+
+    explicit SizeLess(uintmax_t bytes) : bytes(bytes) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        const auto size = candidate.size();
+        return size && *size < bytes;
+    }
+
+private:
+    uintmax_t bytes;
+};
+
+class ModifiedAfter : public Expression<ModifiedAfter> {
+public:
+    static constexpr unsigned needs = NeedModificationTime;
+
+    explicit ModifiedAfter(std::filesystem::file_time_type time) : time(time) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        const auto mtime = candidate.modificationTime();
+        return mtime && *mtime > time;
+    }
+
+private:
+    std::filesystem::file_time_type time;
+};
+
+class ModifiedBefore : public Expression<ModifiedBefore> {
+public:
+    static constexpr unsigned needs = NeedModificationTime;
+
+    explicit ModifiedBefore(std::filesystem::file_time_type time) : time(time) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        const auto mtime = candidate.modificationTime();
+        return mtime && *mtime < time;
+    }
+
+private:
+    std::filesystem::file_time_type time;
+};
+
+// Wraps a path predicate (e.g. an existing lambda) so it can be composed
+template <typename Callable>
+class PathPredicate : public Expression<PathPredicate<Callable>> {
+public:
+    static constexpr unsigned needs = NeedNothing;
+
+    explicit PathPredicate(Callable callable) : callable(std::move(callable)) {}
+
+    [[nodiscard]] bool test(const Candidate& candidate) const {
+        return callable(candidate.path());
+    }
+
+private:
+    Callable callable;
+};
+
+inline Extension ext(std::string extension) { return Extension(std::move(extension)); }
+inline NameGlob name_glob(std::string pattern) { return NameGlob(std::move(pattern)); }
+inline SizeGreater size_gt(uintmax_t bytes) { return SizeGreater(bytes); }
+inline SizeLess size_lt(uintmax_t bytes) { return SizeLess(bytes); }
+inline ModifiedAfter mtime_after(std::filesystem::file_time_type time) { return ModifiedAfter(time); }
+inline ModifiedBefore mtime_before(std::filesystem::file_time_type time) { return ModifiedBefore(time); }
+
+template <typename Callable>
+PathPredicate<Callable> where(Callable callable) { return PathPredicate<Callable>(std::move(callable)); }
+
+namespace literals {
+constexpr uintmax_t operator""_KB(unsigned long long value) { return value * 1024ULL; }
+constexpr uintmax_t operator""_MB(unsigned long long value) { return value * 1024ULL * 1024ULL; }
+constexpr uintmax_t operator""_GB(unsigned long long value) { return value * 1024ULL * 1024ULL * 1024ULL; }
+} // namespace literals
+
+} // namespace FileFilter
+
+#endif // FILEFILTER_H
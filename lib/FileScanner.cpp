@@ -6,6 +6,28 @@
 #include "FileScanner.h"
 #include <stdexcept>
 
+namespace {
+
+// Filter accepting files whose name matches any of the regex patterns
+auto makeRegexFilter(const std::vector<std::string>& patterns) {
+    std::vector<std::regex> regexList;
+    for (const auto& pattern : patterns) {
+        regexList.emplace_back(pattern);
+    }
+
+    return [regexList = std::move(regexList)](const std::filesystem::path& path) {
+        const std::string filename = path.filename().string();
+        for (const auto& regex : regexList) {
+            if (std::regex_match(filename, regex)) {
+                return true;
+            }
+        }
+        return false;
+    };
+}
+
+} // namespace
+
 // Singleton instance accessor
 FileScanner& FileScanner::getInstance() {
     static FileScanner instance;
@@ -20,24 +42,30 @@ FileScanner::~FileScanner() = default;
 
 // Scan using regex patterns (optionally recursive)
 void FileScanner::scan(const std::filesystem::path& directory, FileEntryVec& entries, const std::vector<std::string>& patterns, bool recursive) {
-    std::vector<std::regex> regexList;
-    for (const auto& pattern : patterns) {
-        regexList.emplace_back(pattern);
-    }
+    scan(directory, entries, makeRegexFilter(patterns), recursive);
+}
 
-    auto filter = [&regexList](const std::filesystem::path& path) {
-        const std::string filename = path.filename().string();
-        for (const auto& regex : regexList) {
-            if (std::regex_match(filename, regex)) {
-                return true;
-            }
-        }
-        return false;
-    };
+void FileScanner::scan(const std::filesystem::path& directory, FileEntryContainer& entries, const std::vector<std::string>& patterns, bool recursive) {
+    scan(directory, entries, makeRegexFilter(patterns), recursive);
+}
+
+// Scan using regex patterns with scan options
+bool FileScanner::scan(const std::filesystem::path& directory, FileEntryVec& entries, const std::vector<std::string>& patterns, const ScanOptions& options) {
+    return scan(directory, entries, makeRegexFilter(patterns), options);
+}
+
+bool FileScanner::scan(const std::filesystem::path& directory, FileEntryContainer& entries, const std::vector<std::string>& patterns, const ScanOptions& options) {
+    return scan(directory, entries, makeRegexFilter(patterns), options);
+}
+
+bool FileScanner::scan(const std::filesystem::path& directory, ScanResultWriter& writer, const std::vector<std::string>& patterns, const ScanOptions& options) {
+    return scan(directory, writer, makeRegexFilter(patterns), options);
+}
 
-    if (recursive) {
-        scanImpl<std::filesystem::recursive_directory_iterator>(directory, entries, filter);
-    } else {
-        scanImpl<std::filesystem::directory_iterator>(directory, entries, filter);
+bool FileScanner::markVisited(const std::filesystem::path& directory, std::set<std::pair<uint64_t, uint64_t>>& visited) {
+    const auto metadata = FileEntry::readMetadata(directory);
+    if (!metadata || metadata->inode == 0) {
+        return true;
     }
+    return visited.emplace(metadata->device, metadata->inode).second;
 }
@@ -8,11 +8,36 @@
 
 #include "FileEntry.h"
 #include "FileEntryContainer.h"
+#include "FileFilter.h"
+#include "IoThrottle.h"
+#include "ScanResultFile.h"
 #include <filesystem>
 #include <regex>
 #include <functional>
 #include <vector>
 #include <memory>
+#include <set>
+#include <utility>
+
+enum class SymlinkPolicy {
+    Ignore,        // Skip symlinks entirely
+    FollowFiles,   // Include symlinks to files, do not descend into symlinked directories
+    FollowAll,     // Also descend into symlinked directories, skipping directories already visited
+};
+
+struct ScanOptions {
+    bool recursive = false;
+    // Deepest level descended into below the scanned directory (0 = its entries only); -1 is unlimited
+    int maxDepth = -1;
+    // Stop after visiting this many directory entries; 0 is unlimited
+    size_t maxEntries = 0;
+    SymlinkPolicy symlinkPolicy = SymlinkPolicy::FollowFiles;
+    bool skipPermissionDenied = false;
+    // Token bucket limit on directory entries visited per second; 0 is unlimited
+    double maxEntriesPerSecond = 0;
+    // Run the scan in the idle I/O scheduling class (Linux)
+    bool idlePriority = false;
+};
 
 // FileScanner Singleton Class
 class FileScanner {
@@ -30,23 +55,46 @@ public:
     void scan(const std::filesystem::path& directory, FileEntryVec& entries, const std::vector<std::string>& patterns, bool recursive = false);
     void scan(const std::filesystem::path& directory, FileEntryContainer& entries, const std::vector<std::string>& patterns, bool recursive = false);
 
-    // Scan with a callable filter (optionally recursive)
+    // Scan with a callable filter (optionally recursive). The filter is either a callable taking
+    // a path, or a FileFilter expression which is evaluated against the directory entry.
     template <typename Callable>
     void scan(const std::filesystem::path& directory, FileEntryVec& entries, Callable filter, bool recursive = false);
 
     template <typename Callable>
     void scan(const std::filesystem::path& directory, FileEntryContainer& entries, Callable filter, bool recursive = false);
 
+    // Scan with depth/entry budgets, symlink policy and I/O throttling. Returns false if
+    // the maxEntries budget ran out before the whole tree was visited.
+    bool scan(const std::filesystem::path& directory, FileEntryVec& entries, const std::vector<std::string>& patterns, const ScanOptions& options);
+    bool scan(const std::filesystem::path& directory, FileEntryContainer& entries, const std::vector<std::string>& patterns, const ScanOptions& options);
+
+    template <typename Callable>
+    bool scan(const std::filesystem::path& directory, FileEntryVec& entries, Callable filter, const ScanOptions& options);
+
+    template <typename Callable>
+    bool scan(const std::filesystem::path& directory, FileEntryContainer& entries, Callable filter, const ScanOptions& options);
+
+    // Scan straight into a serialized result; every accepted file is stat'ed once and written
+    // with its metadata. Files that vanish before they are stat'ed are left out.
+    bool scan(const std::filesystem::path& directory, ScanResultWriter& writer, const std::vector<std::string>& patterns, const ScanOptions& options);
+
+    template <typename Callable>
+    bool scan(const std::filesystem::path& directory, ScanResultWriter& writer, Callable filter, const ScanOptions& options);
+
 private:
     // Private constructor for singleton
     FileScanner();
     ~FileScanner();
 
-    // Helper for recursive or non-recursive scanning
-    template <typename IteratorType, typename Callable>
-    void scanImpl(const std::filesystem::path& directory, FileEntryVec& entries, Callable filter);
-    template <typename IteratorType, typename Callable>
-    void scanImpl(const std::filesystem::path& directory, FileEntryContainer& entries, Callable filter);
+    // Walks the directory and hands every accepted file to sink
+    template <typename Callable, typename Sink>
+    bool scanImpl(const std::filesystem::path& directory, Callable& filter, const ScanOptions& options, Sink sink);
+
+    // Records a directory for symlink loop detection; false if it was visited before
+    static bool markVisited(const std::filesystem::path& directory, std::set<std::pair<uint64_t, uint64_t>>& visited);
+
+    template <typename Callable>
+    static bool accept(Callable& filter, const std::filesystem::directory_entry& entry);
 };
 
 #include "FileScanner.tpp" // Include template implementation
@@ -11,43 +11,103 @@
 
 template <typename Callable>
 void FileScanner::scan(const std::filesystem::path& directory, FileEntryVec& entries, Callable filter, bool recursive) {
-    if (recursive) {
-        scanImpl<std::filesystem::recursive_directory_iterator>(directory, entries, filter);
-    } else {
-        scanImpl<std::filesystem::directory_iterator>(directory, entries, filter);
-    }
+    ScanOptions options;
+    options.recursive = recursive;
+    scan(directory, entries, std::move(filter), options);
 }
 
-template <typename IteratorType, typename Callable>
-void FileScanner::scanImpl(const std::filesystem::path& directory, FileEntryVec& entries, Callable filter) {
-    for (const auto& entry : IteratorType(directory)) {
-        if (entry.is_regular_file()) {
-            const auto& path = entry.path();
-            if (filter(path)) {
-                entries.push_back(FileEntry::newEntry(path));
-            }
-        }
-    }
+template <typename Callable>
+void FileScanner::scan(const std::filesystem::path& directory, FileEntryContainer& entries, Callable filter, bool recursive) {
+    ScanOptions options;
+    options.recursive = recursive;
+    scan(directory, entries, std::move(filter), options);
 }
 
 template <typename Callable>
-void FileScanner::scan(const std::filesystem::path& directory, FileEntryContainer& entries, Callable filter, bool recursive) {
-    if (recursive) {
-        scanImpl<std::filesystem::recursive_directory_iterator>(directory, entries, filter);
-    } else {
-        scanImpl<std::filesystem::directory_iterator>(directory, entries, filter);
-    }
+bool FileScanner::scan(const std::filesystem::path& directory, FileEntryVec& entries, Callable filter, const ScanOptions& options) {
+    return scanImpl(directory, filter, options, [&entries](const std::filesystem::path& path) {
+        entries.push_back(FileEntry::newEntry(path));
+    });
 }
 
-template <typename IteratorType, typename Callable>
-void FileScanner::scanImpl(const std::filesystem::path& directory, FileEntryContainer& entries, Callable filter) {
-    for (const auto& entry : IteratorType(directory)) {
-        if (entry.is_regular_file()) {
-            const auto& path = entry.path();
-            if (filter(path)) {
-                entries.append(path);
+template <typename Callable>
+bool FileScanner::scan(const std::filesystem::path& directory, FileEntryContainer& entries, Callable filter, const ScanOptions& options) {
+    return scanImpl(directory, filter, options, [&entries](const std::filesystem::path& path) {
+        entries.append(path);
+    });
+}
+
+template <typename Callable>
+bool FileScanner::scan(const std::filesystem::path& directory, ScanResultWriter& writer, Callable filter, const ScanOptions& options) {
+    return scanImpl(directory, filter, options, [&writer](const std::filesystem::path& path) {
+        writer.append(path);
+    });
+}
+
+template <typename Callable, typename Sink>
+bool FileScanner::scanImpl(const std::filesystem::path& directory, Callable& filter, const ScanOptions& options, Sink sink) {
+    const IoPriorityGuard priority(options.idlePriority);
+    RateLimiter limiter(options.maxEntriesPerSecond);
+
+    const bool followAll = options.symlinkPolicy == SymlinkPolicy::FollowAll;
+    const int maxDepth = options.recursive ? options.maxDepth : 0;
+
+    auto iteratorOptions = std::filesystem::directory_options::none;
+    if (followAll) {
+        iteratorOptions |= std::filesystem::directory_options::follow_directory_symlink;
+    }
+    if (options.skipPermissionDenied) {
+        iteratorOptions |= std::filesystem::directory_options::skip_permission_denied;
+    }
+
+    std::set<std::pair<uint64_t, uint64_t>> visited;
+    if (followAll) {
+        markVisited(directory, visited);
+    }
+
+    size_t visitedEntries = 0;
+    for (std::filesystem::recursive_directory_iterator it(directory, iteratorOptions), end; it != end; ++it) {
+        if (options.maxEntries != 0 && visitedEntries >= options.maxEntries) {
+            return false;
+        }
+        ++visitedEntries;
+        limiter.acquire();
+
+        const auto& entry = *it;
+        const bool atMaxDepth = maxDepth >= 0 && it.depth() >= maxDepth;
+        if (atMaxDepth) {
+            it.disable_recursion_pending();
+        }
+
+        if (entry.is_symlink()) {
+            if (options.symlinkPolicy == SymlinkPolicy::Ignore) {
+                it.disable_recursion_pending();
+                continue;
             }
         }
+        // Only directories that are descended count as visited: one cut off by maxDepth may
+        // still be reached at a shallower depth through a symlink
+        if (followAll && !atMaxDepth && entry.is_directory() && !markVisited(entry.path(), visited)) {
+            // Already seen through another path: a symlink loop or a second link to the same tree
+            it.disable_recursion_pending();
+            continue;
+        }
+
+        if (entry.is_regular_file() && accept(filter, entry)) {
+            sink(entry.path());
+        }
+    }
+
+    return true;
+}
+
+// Filter expressions see the directory entry (and its cached metadata); plain callables see the path
+template <typename Callable>
+bool FileScanner::accept(Callable& filter, const std::filesystem::directory_entry& entry) {
+    if constexpr (FileFilter::isExpression<Callable>) {
+        return filter(entry);
+    } else {
+        return filter(entry.path());
     }
 }
 
@@ -0,0 +1,76 @@
+//
+// IoThrottle.cpp
+// Helpers for keeping background I/O at a predictable cost
+//
+
+#include "IoThrottle.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+RateLimiter::RateLimiter(double rate, double burst)
+    : rate(std::max(rate, 0.0)), capacity(burst > 0 ? burst : std::max(rate, 1.0)), available(capacity),
+      last(std::chrono::steady_clock::now()) {
+}
+
+void RateLimiter::acquire(double tokens) {
+    if (!isLimited()) {
+        return;
+    }
+
+    std::chrono::duration<double> wait{};
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto now = std::chrono::steady_clock::now();
+        const std::chrono::duration<double> elapsed = now - last;
+        last = now;
+
+        available = std::min(capacity, available + elapsed.count() * rate);
+        available -= tokens;
+        if (available < 0) {
+            // The debt is paid off by sleeping; later callers queue up behind it
+            wait = std::chrono::duration<double>(-available / rate);
+        }
+    }
+
+    if (wait.count() > 0) {
+        std::this_thread::sleep_for(wait);
+    }
+}
+
+#ifdef __linux__
+namespace {
+// From linux/ioprio.h, which is not shipped by every libc
+constexpr int kIoprioWhoProcess = 1;
+constexpr int kIoprioClassIdle = 3;
+constexpr int kIoprioClassShift = 13;
+} // namespace
+
+IoPriorityGuard::IoPriorityGuard(bool idle) {
+    if (!idle) {
+        return;
+    }
+
+    // Who 0 with IOPRIO_WHO_PROCESS is the calling thread
+    const auto current = syscall(SYS_ioprio_get, kIoprioWhoProcess, 0);
+    if (current >= 0 && syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, kIoprioClassIdle << kIoprioClassShift) == 0) {
+        previous = static_cast<int>(current);
+    }
+}
+
+IoPriorityGuard::~IoPriorityGuard() {
+    if (previous >= 0) {
+        syscall(SYS_ioprio_set, kIoprioWhoProcess, 0, previous);
+    }
+}
+#else
+IoPriorityGuard::IoPriorityGuard(bool) {
+}
+
+IoPriorityGuard::~IoPriorityGuard() = default;
+#endif
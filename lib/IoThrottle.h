@@ -0,0 +1,49 @@
+//
+// IoThrottle.h
+// Helpers for keeping background I/O at a predictable cost
+//
+
+#ifndef IOTHROTTLE_H
+#define IOTHROTTLE_H
+
+#include <chrono>
+#include <mutex>
+
+// Token bucket. acquire() takes tokens from the bucket and sleeps while it is in debt,
+// so the long-run rate never exceeds `rate` tokens per second. Safe to share between threads.
+class RateLimiter {
+public:
+    // A rate of 0 disables the limit. The burst defaults to one second's worth of tokens.
+    explicit RateLimiter(double rate = 0, double burst = 0);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    void acquire(double tokens = 1);
+    [[nodiscard]] bool isLimited() const { return rate > 0; }
+
+private:
+    const double rate;
+    const double capacity;
+    double available;
+    std::chrono::steady_clock::time_point last;
+    std::mutex mutex;
+};
+
+// Moves the calling thread to the idle I/O scheduling class (ioprio_set) for the lifetime
+// of the guard and restores the previous priority afterwards. A no-op outside Linux.
+class IoPriorityGuard {
+public:
+    explicit IoPriorityGuard(bool idle);
+    ~IoPriorityGuard();
+
+    IoPriorityGuard(const IoPriorityGuard&) = delete;
+    IoPriorityGuard& operator=(const IoPriorityGuard&) = delete;
+
+    [[nodiscard]] bool isActive() const { return previous >= 0; }
+
+private:
+    int previous = -1;
+};
+
+#endif // IOTHROTTLE_H
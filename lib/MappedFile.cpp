@@ -0,0 +1,70 @@
+//
+// MappedFile.cpp
+// Read-only, whole-file view used by the on-disk index and result formats
+//
+
+#include "MappedFile.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::filesystem::path& path) {
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open file: " + path.string());
+    }
+    return read(in);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + path.string());
+    }
+
+    struct stat fileStat{};
+    if (::fstat(fd, &fileStat) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not stat file: " + path.string());
+    }
+    if (fileStat.st_size == 0) {
+        ::close(fd);
+        return std::make_shared<const MappedFile>(std::string());
+    }
+
+    const auto size = static_cast<size_t>(fileStat.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Could not map file: " + path.string());
+    }
+
+    return std::shared_ptr<const MappedFile>(new MappedFile(static_cast<const char*>(mapping), size));
+#endif
+}
+
+std::shared_ptr<const MappedFile> MappedFile::read(std::istream& in) {
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return std::make_shared<const MappedFile>(std::move(bytes));
+}
+
+MappedFile::MappedFile(std::string bytes) : owned(std::move(bytes)), bytes(owned.data()), length(owned.size()) {
+}
+
+MappedFile::MappedFile(const char* mapping, size_t length) : bytes(mapping), length(length), mapped(true) {
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (mapped) {
+        ::munmap(const_cast<char*>(bytes), length);
+    }
+#endif
+}
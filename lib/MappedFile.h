@@ -0,0 +1,41 @@
+//
+// MappedFile.h
+// Read-only, whole-file view used by the on-disk index and result formats
+//
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <istream>
+#include <memory>
+#include <string>
+
+// The bytes of a file, memory-mapped where the platform allows it and read into memory
+// otherwise. Can also wrap bytes that are already in memory, so readers of a format have
+// a single code path. The data is at least 8 byte aligned.
+class MappedFile {
+public:
+    static std::shared_ptr<const MappedFile> open(const std::filesystem::path& path);
+    static std::shared_ptr<const MappedFile> read(std::istream& in);
+
+    explicit MappedFile(std::string bytes);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const char* data() const { return bytes; }
+    [[nodiscard]] size_t size() const { return length; }
+
+private:
+    MappedFile(const char* mapping, size_t length);
+
+    std::string owned;
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,409 @@
+//
+// ScanResultFile.cpp
+// Compact columnar serialization of scan results and their metadata
+//
+
+#include "ScanResultFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'S', 'I', 'L', 'S', 'C', 'A', 'N'};
+constexpr char kTrailerMagic[8] = {'F', 'S', 'I', 'L', 'S', 'E', 'N', 'D'};
+constexpr uint32_t kVersion = 1;
+
+constexpr uint32_t kChecksums = 1;   // FileHeader flag
+constexpr uint32_t kRestartInterval = 16;
+// Keeps the 32-bit restart offsets in range whatever entriesPerChunk is
+constexpr size_t kMaxChunkPathBytes = size_t{1} << 30;
+
+// On-disk layout; every chunk and column starts at an 8 byte aligned offset
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+};
+
+struct ChunkHeader {
+    uint32_t entryCount;
+    uint32_t restartCount;
+    uint64_t byteSize;        // Including this header
+    uint64_t pathBytes;
+    uint64_t checksum;        // Of everything after this header; 0 without checksums
+};
+
+struct Trailer {
+    uint64_t entryCount;
+    uint64_t chunkCount;
+    char magic[8];
+};
+
+size_t padded(size_t size) {
+    return (size + 7) & ~size_t{7};
+}
+
+size_t chunkSize(uint64_t entryCount, uint64_t restartCount, uint64_t pathBytes) {
+    return sizeof(ChunkHeader) + 2 * 8 * entryCount + padded(4 * entryCount) + padded(4 * restartCount) +
+           padded(pathBytes);
+}
+
+// FNV-1a over 64-bit words; the payload is always a whole number of words
+uint64_t checksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    return hash;
+}
+
+void appendVarint(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+uint32_t readVarint(const char*& position, const char* end) {
+    uint32_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        if (position == end || shift > 28) {
+            throw std::runtime_error("Corrupt scan result path column");
+        }
+        const auto byte = static_cast<unsigned char>(*position++);
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+}
+
+template <typename T>
+void appendColumn(std::string& out, const std::vector<T>& column) {
+    out.append(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+    out.resize(padded(out.size()), '\0');
+}
+
+uint32_t encodeMode(const FileMetadata& metadata) {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(metadata.type)) << 16) |
+           (static_cast<uint32_t>(metadata.permissions) & 0xffff);
+}
+
+void writeBytes(std::ostream& out, const void* data, size_t size) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!out) {
+        throw std::runtime_error("Could not write scan result");
+    }
+}
+
+} // namespace
+
+ScanResultWriter::ScanResultWriter(const std::filesystem::path& path, ScanResultOptions options)
+    : options(options), out(file), destination(path), temporary(path) {
+    temporary += ".fsiltmp";
+    file.open(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not create file: " + temporary.string());
+    }
+    writeHeader();
+}
+
+ScanResultWriter::ScanResultWriter(std::ostream& out, ScanResultOptions options) : options(options), out(out) {
+    writeHeader();
+}
+
+ScanResultWriter::~ScanResultWriter() {
+    // An unfinished file result is discarded; an unfinished stream lacks its trailer
+    if (!finished && !temporary.empty()) {
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(temporary, ec);
+    }
+}
+
+void ScanResultWriter::writeHeader() {
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.flags = options.checksums ? kChecksums : 0;
+    writeBytes(out, &header, sizeof(header));
+}
+
+void ScanResultWriter::append(const std::filesystem::path& path, const FileMetadata& metadata) {
+    if (finished) {
+        throw std::runtime_error("Scan result already finished");
+    }
+
+    auto text = path.string();
+    const auto index = static_cast<uint32_t>(sizes.size());
+    size_t shared = 0;
+    if (index % kRestartInterval == 0) {
+        restarts.push_back(static_cast<uint32_t>(paths.size()));
+    } else {
+        const auto limit = std::min(text.size(), previousPath.size());
+        while (shared < limit && text[shared] == previousPath[shared]) {
+            ++shared;
+        }
+    }
+    appendVarint(paths, static_cast<uint32_t>(shared));
+    appendVarint(paths, static_cast<uint32_t>(text.size() - shared));
+    paths.append(text, shared, std::string::npos);
+    previousPath = std::move(text);
+
+    sizes.push_back(metadata.size);
+    modificationTimes.push_back(static_cast<int64_t>(metadata.modificationTime.time_since_epoch().count()));
+    modes.push_back(encodeMode(metadata));
+    ++entryCount;
+
+    if (sizes.size() >= options.entriesPerChunk || paths.size() >= kMaxChunkPathBytes) {
+        flushChunk();
+    }
+}
+
+bool ScanResultWriter::append(const std::filesystem::path& path) {
+    const auto metadata = FileEntry::readMetadata(path);
+    if (!metadata) {
+        return false;
+    }
+    append(path, *metadata);
+    return true;
+}
+
+size_t ScanResultWriter::append(const FileEntryContainer& entries) {
+    size_t written = 0;
+    entries.foreach([this, &written](const FileEntry& entry) {
+        if (append(entry.getPath())) {
+            ++written;
+        }
+        return true;
+    });
+    return written;
+}
+
+void ScanResultWriter::flushChunk() {
+    if (sizes.empty()) {
+        return;
+    }
+
+    ChunkHeader header{};
+    header.entryCount = static_cast<uint32_t>(sizes.size());
+    header.restartCount = static_cast<uint32_t>(restarts.size());
+    header.byteSize = chunkSize(sizes.size(), restarts.size(), paths.size());
+    header.pathBytes = paths.size();
+
+    std::string chunk(sizeof(ChunkHeader), '\0');
+    chunk.reserve(header.byteSize);
+    appendColumn(chunk, sizes);
+    appendColumn(chunk, modificationTimes);
+    appendColumn(chunk, modes);
+    appendColumn(chunk, restarts);
+    chunk += paths;
+    chunk.resize(padded(chunk.size()), '\0');
+
+    if (options.checksums) {
+        header.checksum = checksum(chunk.data() + sizeof(ChunkHeader), chunk.size() - sizeof(ChunkHeader));
+    }
+    std::memcpy(chunk.data(), &header, sizeof(header));
+    writeBytes(out, chunk.data(), chunk.size());
+    ++chunkCount;
+
+    sizes.clear();
+    modificationTimes.clear();
+    modes.clear();
+    restarts.clear();
+    paths.clear();
+    previousPath.clear();
+}
+
+void ScanResultWriter::finish() {
+    if (finished) {
+        return;
+    }
+
+    flushChunk();
+    Trailer trailer{};
+    trailer.entryCount = entryCount;
+    trailer.chunkCount = chunkCount;
+    std::memcpy(trailer.magic, kTrailerMagic, sizeof(kTrailerMagic));
+    writeBytes(out, &trailer, sizeof(trailer));
+    out.flush();
+
+    if (!temporary.empty()) {
+        file.close();
+        if (!file) {
+            throw std::runtime_error("Could not write file: " + temporary.string());
+        }
+        std::filesystem::rename(temporary, destination);
+    }
+    finished = true;
+}
+
+size_t ScanResultWriter::size() const {
+    return entryCount;
+}
+
+ScanResultReader ScanResultReader::load(const std::filesystem::path& path, bool verifyChecksums) {
+    return ScanResultReader(MappedFile::open(path), verifyChecksums);
+}
+
+ScanResultReader ScanResultReader::read(std::istream& in, bool verifyChecksums) {
+    return ScanResultReader(MappedFile::read(in), verifyChecksums);
+}
+
+ScanResultReader::ScanResultReader(std::shared_ptr<const MappedFile> file, bool verifyChecksums)
+    : file(std::move(file)) {
+    const char* data = this->file->data();
+    const size_t size = this->file->size();
+
+    FileHeader header{};
+    if (size < sizeof(FileHeader)) {
+        throw std::runtime_error("Not a scan result");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a scan result");
+    }
+    if (header.version != kVersion) {
+        throw std::runtime_error("Unsupported scan result version");
+    }
+    checksums = (header.flags & kChecksums) != 0;
+
+    Trailer trailer{};
+    if (size < sizeof(FileHeader) + sizeof(Trailer)) {
+        throw std::runtime_error("Truncated scan result");
+    }
+    std::memcpy(&trailer, data + size - sizeof(Trailer), sizeof(trailer));
+    if (std::memcmp(trailer.magic, kTrailerMagic, sizeof(kTrailerMagic)) != 0) {
+        throw std::runtime_error("Truncated scan result");
+    }
+
+    const size_t end = size - sizeof(Trailer);
+    size_t offset = sizeof(FileHeader);
+    while (offset < end) {
+        ChunkHeader chunkHeader{};
+        if (end - offset < sizeof(ChunkHeader)) {
+            throw std::runtime_error("Corrupt scan result");
+        }
+        std::memcpy(&chunkHeader, data + offset, sizeof(chunkHeader));
+
+        const uint64_t count = chunkHeader.entryCount;
+        if (count == 0 || chunkHeader.restartCount != (count + kRestartInterval - 1) / kRestartInterval ||
+            chunkHeader.byteSize > end - offset || chunkHeader.pathBytes > chunkHeader.byteSize ||
+            chunkHeader.byteSize != chunkSize(count, chunkHeader.restartCount, chunkHeader.pathBytes)) {
+            throw std::runtime_error("Corrupt scan result");
+        }
+
+        const char* base = data + offset;
+        const char* payload = base + sizeof(ChunkHeader);
+        if (checksums && verifyChecksums &&
+            checksum(payload, chunkHeader.byteSize - sizeof(ChunkHeader)) != chunkHeader.checksum) {
+            throw std::runtime_error("Scan result checksum mismatch");
+        }
+
+        Chunk chunk;
+        chunk.first = entryCount;
+        chunk.count = chunkHeader.entryCount;
+        chunk.sizes = reinterpret_cast<const uint64_t*>(payload);
+        chunk.modificationTimes = reinterpret_cast<const int64_t*>(payload + 8 * count);
+        chunk.modes = reinterpret_cast<const uint32_t*>(payload + 16 * count);
+        chunk.restarts = reinterpret_cast<const uint32_t*>(payload + 16 * count + padded(4 * count));
+        chunk.restartCount = chunkHeader.restartCount;
+        chunk.paths = reinterpret_cast<const char*>(chunk.restarts) + padded(4 * chunk.restartCount);
+        chunk.pathBytes = chunkHeader.pathBytes;
+        for (uint32_t i = 0; i < chunk.restartCount; ++i) {
+            if (chunk.restarts[i] >= chunk.pathBytes) {
+                throw std::runtime_error("Corrupt scan result");
+            }
+        }
+
+        chunks.push_back(chunk);
+        entryCount += chunk.count;
+        offset += chunkHeader.byteSize;
+    }
+
+    if (trailer.entryCount != entryCount || trailer.chunkCount != chunks.size()) {
+        throw std::runtime_error("Corrupt scan result");
+    }
+}
+
+size_t ScanResultReader::size() const {
+    return entryCount;
+}
+
+bool ScanResultReader::hasChecksums() const {
+    return checksums;
+}
+
+ScanRecord ScanResultReader::record(const Chunk& chunk, uint32_t index, std::string& pathBuffer,
+                                    const char*& position) {
+    const char* end = chunk.paths + chunk.pathBytes;
+    if (index % kRestartInterval == 0) {
+        position = chunk.paths + chunk.restarts[index / kRestartInterval];
+        pathBuffer.clear();
+    }
+
+    const auto shared = readVarint(position, end);
+    const auto length = readVarint(position, end);
+    if (shared > pathBuffer.size() || length > static_cast<size_t>(end - position)) {
+        throw std::runtime_error("Corrupt scan result path column");
+    }
+    pathBuffer.resize(shared);
+    pathBuffer.append(position, length);
+    position += length;
+
+    const uint32_t mode = chunk.modes[index];
+    ScanRecord record;
+    record.path = pathBuffer;
+    record.size = chunk.sizes[index];
+    record.modificationTime = std::filesystem::file_time_type(
+            std::filesystem::file_time_type::duration(chunk.modificationTimes[index]));
+    record.permissions = static_cast<std::filesystem::perms>(mode & 0xffff);
+    record.type = static_cast<std::filesystem::file_type>(static_cast<int8_t>(mode >> 16));
+    return record;
+}
+
+bool ScanResultReader::foreach(const std::function<bool(const ScanRecord&)>& callback) const {
+    std::string pathBuffer;
+    for (const auto& chunk : chunks) {
+        const char* position = chunk.paths;
+        for (uint32_t i = 0; i < chunk.count; ++i) {
+            if (!callback(record(chunk, i, pathBuffer, position))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+ScanRecord ScanResultReader::at(size_t index, std::string& pathBuffer) const {
+    if (index >= entryCount) {
+        throw std::out_of_range("Index out of range");
+    }
+
+    const auto chunk = std::upper_bound(chunks.begin(), chunks.end(), index, [](size_t value, const Chunk& c) {
+        return value < c.first;
+    }) - 1;
+    const auto local = static_cast<uint32_t>(index - chunk->first);
+
+    // Decode forward from the closest restart point
+    const char* position = nullptr;
+    ScanRecord result;
+    for (uint32_t i = local - local % kRestartInterval; i <= local; ++i) {
+        result = record(*chunk, i, pathBuffer, position);
+    }
+    return result;
+}
+
+FileEntryContainer ScanResultReader::toContainer() const {
+    FileEntryContainer container;
+    foreach([&container](const ScanRecord& record) {
+        container.append(std::filesystem::path(record.path));
+        return true;
+    });
+    return container;
+}
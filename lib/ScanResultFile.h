@@ -0,0 +1,135 @@
+//
+// ScanResultFile.h
+// Compact columnar serialization of scan results and their metadata
+//
+
+#ifndef SCANRESULTFILE_H
+#define SCANRESULTFILE_H
+
+#include "FileEntry.h"
+#include "FileEntryContainer.h"
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One serialized entry. path points into a buffer owned by the reader and is only
+// valid until the next record is produced.
+struct ScanRecord {
+    std::string_view path;
+    uintmax_t size = 0;
+    std::filesystem::file_time_type modificationTime{};
+    std::filesystem::perms permissions = std::filesystem::perms::unknown;
+    std::filesystem::file_type type = std::filesystem::file_type::none;
+};
+
+struct ScanResultOptions {
+    // Entries buffered before a chunk is written out
+    size_t entriesPerChunk = 64 * 1024;
+    // Store a checksum of every chunk, verified when the result is loaded
+    bool checksums = true;
+};
+
+// Writes scan results in chunks of entriesPerChunk entries. Each chunk holds fixed-width
+// size, modification time and mode columns, and a front-coded path column: every path
+// stores the length of the prefix it shares with the previous one and the remaining bytes,
+// restarting every 16 entries so single records can be decoded without the whole chunk.
+//
+// Chunks are written as soon as they fill up, so a writer can be fed during a scan (see
+// FileScanner::scan) and its output consumed from a pipe. finish() writes the trailer; a
+// result without one is rejected as truncated. When writing to a path, the file is created
+// under a temporary name and only renamed into place by finish().
+class ScanResultWriter {
+public:
+    explicit ScanResultWriter(const std::filesystem::path& path, ScanResultOptions options = {});
+    explicit ScanResultWriter(std::ostream& out, ScanResultOptions options = {});
+    ~ScanResultWriter();
+
+    ScanResultWriter(const ScanResultWriter&) = delete;
+    ScanResultWriter& operator=(const ScanResultWriter&) = delete;
+
+    void append(const std::filesystem::path& path, const FileMetadata& metadata);
+    // Stats the file; returns false (and writes nothing) if it cannot be stat'ed
+    bool append(const std::filesystem::path& path);
+    // Appends every entry that can be stat'ed; returns the number written
+    size_t append(const FileEntryContainer& entries);
+
+    void finish();
+
+    // Entries appended so far
+    [[nodiscard]] size_t size() const;
+
+private:
+    void writeHeader();
+    void flushChunk();
+
+    ScanResultOptions options;
+    std::ofstream file;
+    std::ostream& out;
+    std::filesystem::path destination;
+    std::filesystem::path temporary;
+    bool finished = false;
+
+    size_t entryCount = 0;
+    size_t chunkCount = 0;
+
+    // Columns of the chunk being filled
+    std::vector<uint64_t> sizes;
+    std::vector<int64_t> modificationTimes;
+    std::vector<uint32_t> modes;
+    std::vector<uint32_t> restarts;
+    std::string paths;
+    std::string previousPath;
+};
+
+// Reads a serialized scan result in place. Loading validates the layout (and checksums)
+// chunk by chunk; entries are decoded on the fly as they are visited, with no allocation
+// per entry.
+class ScanResultReader {
+public:
+    static ScanResultReader load(const std::filesystem::path& path, bool verifyChecksums = true);
+    static ScanResultReader read(std::istream& in, bool verifyChecksums = true);
+
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] bool hasChecksums() const;
+
+    // Visits the entries in the order they were written; returns false if the callback stopped the iteration
+    bool foreach(const std::function<bool(const ScanRecord&)>& callback) const;
+
+    // Decodes a single entry; its path is kept in pathBuffer
+    [[nodiscard]] ScanRecord at(size_t index, std::string& pathBuffer) const;
+
+    [[nodiscard]] FileEntryContainer toContainer() const;
+
+private:
+    struct Chunk {
+        size_t first = 0;     // Index of the first entry
+        uint32_t count = 0;
+        const uint64_t* sizes = nullptr;
+        const int64_t* modificationTimes = nullptr;
+        const uint32_t* modes = nullptr;
+        const uint32_t* restarts = nullptr;
+        uint32_t restartCount = 0;
+        const char* paths = nullptr;
+        size_t pathBytes = 0;
+    };
+
+    ScanResultReader(std::shared_ptr<const MappedFile> file, bool verifyChecksums);
+
+    [[nodiscard]] static ScanRecord record(const Chunk& chunk, uint32_t index, std::string& pathBuffer,
+                                           const char*& position);
+
+    std::shared_ptr<const MappedFile> file;
+    std::vector<Chunk> chunks;
+    size_t entryCount = 0;
+    bool checksums = false;
+};
+
+#endif // SCANRESULTFILE_H
@@ -0,0 +1,704 @@
+//
+// TrigramIndex.cpp
+// Trigram full-text index over the contents of a scanned file set
+//
+
+#include "TrigramIndex.h"
+#include "FileEntryContainer.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+constexpr char kMagic[8] = {'F', 'S', 'I', 'L', 'T', 'R', 'I', 'G'};
+constexpr uint32_t kVersion = 1;
+
+constexpr uint32_t kIndexed = 1;   // FileRecord flag: the trigrams of the file are in the index
+constexpr size_t kTrigramSpace = size_t{1} << 24;
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+// Content read at a time when confirming literal candidates
+constexpr size_t kSearchChunk = 64 * 1024;
+
+// On-disk layout; all sections start at 8 byte aligned offsets
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t fileCount;
+    uint64_t trigramCount;
+    uint64_t filesOffset;
+    uint64_t trigramsOffset;
+    uint64_t postingsOffset;
+    uint64_t postingsSize;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+struct FileRecord {
+    uint64_t pathOffset;
+    uint32_t pathLength;
+    uint32_t flags;
+    uint64_t size;
+    int64_t modificationTime;   // file_time_type ticks
+};
+
+struct TrigramRecord {
+    uint32_t trigram;
+    uint32_t fileCount;
+    uint64_t postingsOffset;
+};
+
+struct IndexedFile {
+    std::string path;
+    uint64_t size = 0;
+    int64_t modificationTime = 0;
+    bool indexed = false;
+    std::vector<uint32_t> trigrams;   // Distinct, in no particular order
+};
+
+void appendVarint(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+template <typename T>
+void appendRaw(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void alignTo8(std::string& out) {
+    out.resize((out.size() + 7) & ~size_t{7}, '\0');
+}
+
+std::string serialize(const std::vector<IndexedFile>& files) {
+    // Counting sort of the (trigram, file) pairs over the dense trigram space: count,
+    // turn the counts into start positions, then place the file ids. Ids are placed in
+    // increasing order, so every posting list comes out sorted.
+    size_t pairCount = 0;
+    for (const auto& file : files) {
+        pairCount += file.trigrams.size();
+    }
+    std::vector<uint32_t> positions(pairCount > 0 ? kTrigramSpace : 0, 0);
+    for (const auto& file : files) {
+        for (const auto trigram : file.trigrams) {
+            ++positions[trigram];
+        }
+    }
+
+    std::vector<uint32_t> trigrams;
+    std::vector<size_t> starts;
+    size_t start = 0;
+    for (uint32_t trigram = 0; trigram < positions.size(); ++trigram) {
+        if (positions[trigram] != 0) {
+            trigrams.push_back(trigram);
+            starts.push_back(start);
+            start += positions[trigram];
+            positions[trigram] = static_cast<uint32_t>(trigrams.size() - 1);
+        }
+    }
+    starts.push_back(start);
+
+    std::vector<size_t> cursors(starts.begin(), starts.end() - 1);
+    std::vector<uint32_t> ids(pairCount);
+    for (uint32_t id = 0; id < files.size(); ++id) {
+        for (const auto trigram : files[id].trigrams) {
+            ids[cursors[positions[trigram]]++] = id;
+        }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.fileCount = files.size();
+    header.trigramCount = trigrams.size();
+
+    std::string out(sizeof(Header), '\0');
+
+    header.filesOffset = out.size();
+    uint64_t pathOffset = 0;
+    for (const auto& file : files) {
+        FileRecord record{};
+        record.pathOffset = pathOffset;
+        record.pathLength = static_cast<uint32_t>(file.path.size());
+        record.flags = file.indexed ? kIndexed : 0;
+        record.size = file.size;
+        record.modificationTime = file.modificationTime;
+        appendRaw(out, record);
+        pathOffset += file.path.size();
+    }
+
+    // The table is written with placeholder offsets, patched once the lists are encoded
+    header.trigramsOffset = out.size();
+    out.resize(out.size() + trigrams.size() * sizeof(TrigramRecord), '\0');
+
+    header.postingsOffset = out.size();
+    for (size_t i = 0; i < trigrams.size(); ++i) {
+        TrigramRecord record{};
+        record.trigram = trigrams[i];
+        record.fileCount = static_cast<uint32_t>(starts[i + 1] - starts[i]);
+        record.postingsOffset = out.size() - header.postingsOffset;
+        std::memcpy(out.data() + header.trigramsOffset + i * sizeof(TrigramRecord), &record, sizeof(record));
+
+        uint32_t last = 0;
+        for (size_t j = starts[i]; j < starts[i + 1]; ++j) {
+            appendVarint(out, ids[j] - last);
+            last = ids[j];
+        }
+    }
+    header.postingsSize = out.size() - header.postingsOffset;
+    alignTo8(out);
+
+    header.stringsOffset = out.size();
+    for (const auto& file : files) {
+        out += file.path;
+    }
+    header.stringsSize = out.size() - header.stringsOffset;
+
+    std::memcpy(out.data(), &header, sizeof(Header));
+    return out;
+}
+
+// Distinct trigrams of a string, sorted
+std::vector<uint32_t> trigramsOf(const std::string& text) {
+    std::vector<uint32_t> trigrams;
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        trigrams.push_back((static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16) |
+                           (static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8) |
+                           static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2])));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+// Streams a file once and collects its distinct trigrams, unsorted. seen is a 2^24 bit scratch set,
+// left all clear again on return; it makes the cost independent of how repetitive the file is.
+std::vector<uint32_t> extractTrigrams(const FileEntry& entry, std::vector<uint64_t>& seen) {
+    std::vector<uint32_t> trigrams;
+    auto stream = entry.openContent(1);
+
+    std::string buffer(64 * 1024, '\0');
+    uint32_t window = 0;
+    size_t consumed = 0;
+    while (const size_t count = stream->read(buffer.data(), buffer.size())) {
+        for (size_t i = 0; i < count; ++i) {
+            window = ((window << 8) | static_cast<unsigned char>(buffer[i])) & 0xffffff;
+            if (++consumed < 3) {
+                continue;
+            }
+            auto& word = seen[window >> 6];
+            const uint64_t bit = uint64_t{1} << (window & 63);
+            if (!(word & bit)) {
+                word |= bit;
+                trigrams.push_back(window);
+            }
+        }
+    }
+
+    for (const auto trigram : trigrams) {
+        seen[trigram >> 6] = 0;
+    }
+    return trigrams;
+}
+
+std::vector<uint32_t> intersect(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    std::vector<uint32_t> result;
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    return result;
+}
+
+// Streams the (decompressed) content in kSearchChunk pieces. The last literal.size() - 1
+// bytes of each piece are kept in front of the next one, for matches spanning two pieces.
+bool containsLiteral(const std::filesystem::path& path, const std::string& literal) {
+    auto stream = FileEntry(path).openContent();
+    const size_t overlap = literal.empty() ? 0 : literal.size() - 1;
+
+    std::string window;
+    size_t kept = 0;
+    for (;;) {
+        window.resize(kept + kSearchChunk);
+        const size_t count = stream->read(window.data() + kept, kSearchChunk);
+        window.resize(kept + count);
+        if (window.find(literal) != std::string::npos) {
+            return true;
+        }
+        if (count == 0) {
+            return false;
+        }
+        kept = std::min(overlap, window.size());
+        window.erase(0, window.size() - kept);
+    }
+}
+
+} // namespace
+
+class TrigramIndex::Storage {
+public:
+    explicit Storage(std::shared_ptr<const MappedFile> file)
+        : mapping(std::move(file)), data(mapping->data()), size(mapping->size()) {
+        validate();
+    }
+
+    [[nodiscard]] const char* bytes() const { return data; }
+    [[nodiscard]] size_t byteCount() const { return size; }
+
+    [[nodiscard]] size_t fileCount() const { return header->fileCount; }
+    [[nodiscard]] size_t trigramCount() const { return header->trigramCount; }
+
+    [[nodiscard]] const FileRecord& file(uint32_t id) const { return files[id]; }
+
+    [[nodiscard]] std::string path(uint32_t id) const {
+        return {strings + files[id].pathOffset, files[id].pathLength};
+    }
+
+    [[nodiscard]] const TrigramRecord* find(uint32_t trigram) const {
+        const auto* end = trigrams + header->trigramCount;
+        const auto* found = std::lower_bound(trigrams, end, trigram, [](const TrigramRecord& record, uint32_t value) {
+            return record.trigram < value;
+        });
+        return found != end && found->trigram == trigram ? found : nullptr;
+    }
+
+    [[nodiscard]] const TrigramRecord* trigramTable() const { return trigrams; }
+
+    [[nodiscard]] std::vector<uint32_t> decode(const TrigramRecord& record) const {
+        std::vector<uint32_t> ids;
+        ids.reserve(record.fileCount);
+
+        const char* position = postings + record.postingsOffset;
+        const char* end = postings + header->postingsSize;
+        uint32_t id = 0;
+        for (uint32_t i = 0; i < record.fileCount; ++i) {
+            uint32_t delta = 0;
+            for (int shift = 0;; shift += 7) {
+                if (position == end || shift > 28) {
+                    throw std::runtime_error("Corrupt trigram index posting list");
+                }
+                const auto byte = static_cast<unsigned char>(*position++);
+                delta |= static_cast<uint32_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    break;
+                }
+            }
+            id += delta;
+            if (id >= header->fileCount) {
+                throw std::runtime_error("Corrupt trigram index posting list");
+            }
+            ids.push_back(id);
+        }
+        return ids;
+    }
+
+private:
+    void validate() {
+        if (size < sizeof(Header) || std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+            throw std::runtime_error("Not a trigram index");
+        }
+        header = reinterpret_cast<const Header*>(data);
+        if (header->version != kVersion) {
+            throw std::runtime_error("Unsupported trigram index version");
+        }
+
+        auto inBounds = [this](uint64_t offset, uint64_t count, uint64_t width) {
+            return offset % 8 == 0 && offset <= size && count <= (size - offset) / width;
+        };
+        if (!inBounds(header->filesOffset, header->fileCount, sizeof(FileRecord)) ||
+            !inBounds(header->trigramsOffset, header->trigramCount, sizeof(TrigramRecord)) ||
+            !inBounds(header->postingsOffset, header->postingsSize, 1) ||
+            !inBounds(header->stringsOffset, header->stringsSize, 1) ||
+            header->fileCount >= kNone) {
+            throw std::runtime_error("Corrupt trigram index");
+        }
+
+        files = reinterpret_cast<const FileRecord*>(data + header->filesOffset);
+        trigrams = reinterpret_cast<const TrigramRecord*>(data + header->trigramsOffset);
+        postings = data + header->postingsOffset;
+        strings = data + header->stringsOffset;
+
+        for (uint64_t i = 0; i < header->fileCount; ++i) {
+            if (files[i].pathOffset > header->stringsSize ||
+                files[i].pathLength > header->stringsSize - files[i].pathOffset) {
+                throw std::runtime_error("Corrupt trigram index");
+            }
+        }
+        for (uint64_t i = 0; i < header->trigramCount; ++i) {
+            if (trigrams[i].postingsOffset > header->postingsSize || (i > 0 && trigrams[i].trigram <= trigrams[i - 1].trigram)) {
+                throw std::runtime_error("Corrupt trigram index");
+            }
+        }
+    }
+
+    std::shared_ptr<const MappedFile> mapping;
+    const char* data = nullptr;
+    size_t size = 0;
+
+    const Header* header = nullptr;
+    const FileRecord* files = nullptr;
+    const TrigramRecord* trigrams = nullptr;
+    const char* postings = nullptr;
+    const char* strings = nullptr;
+};
+
+TrigramIndex::TrigramIndex() : storage(std::make_shared<const Storage>(std::make_shared<const MappedFile>(serialize({})))) {
+}
+
+TrigramIndex::TrigramIndex(std::shared_ptr<const Storage> storage) : storage(std::move(storage)) {
+}
+
+TrigramIndex TrigramIndex::build(const FileEntryContainer& entries, const TrigramIndexOptions& options) {
+    return TrigramIndex().update(entries, options);
+}
+
+TrigramIndex TrigramIndex::update(const FileEntryContainer& entries, const TrigramIndexOptions& options) const {
+    std::unordered_map<std::string, uint32_t> previousIds;
+    previousIds.reserve(storage->fileCount());
+    for (uint32_t id = 0; id < storage->fileCount(); ++id) {
+        previousIds.emplace(storage->path(id), id);
+    }
+
+    // Stat every entry; entries that are gone or are not regular files are left out
+    std::vector<IndexedFile> files;
+    std::vector<const FileEntry*> sources;
+    std::vector<uint32_t> reused(storage->fileCount(), kNone);
+    std::vector<uint32_t> pending;
+    files.reserve(entries.size());
+    entries.foreach([&](const FileEntry& entry) {
+        const auto metadata = FileEntry::readMetadata(entry.getPath());
+        if (!metadata || metadata->type != std::filesystem::file_type::regular) {
+            return true;
+        }
+
+        IndexedFile file;
+        file.path = entry.getPath().string();
+        file.size = metadata->size;
+        file.modificationTime = static_cast<int64_t>(metadata->modificationTime.time_since_epoch().count());
+        const auto id = static_cast<uint32_t>(files.size());
+
+        const auto previous = previousIds.find(file.path);
+        if (previous != previousIds.end()) {
+            const auto& record = storage->file(previous->second);
+            if ((record.flags & kIndexed) && record.size == file.size &&
+                record.modificationTime == file.modificationTime && reused[previous->second] == kNone) {
+                reused[previous->second] = id;
+                file.indexed = true;
+            }
+        }
+        if (!file.indexed && file.size <= options.maxFileSize) {
+            pending.push_back(id);
+        }
+
+        files.push_back(std::move(file));
+        sources.push_back(&entry);
+        return true;
+    });
+
+    // Unchanged files get their trigrams back by inverting the old posting lists
+    if (std::any_of(reused.begin(), reused.end(), [](uint32_t id) { return id != kNone; })) {
+        const auto* table = storage->trigramTable();
+        for (size_t i = 0; i < storage->trigramCount(); ++i) {
+            for (const auto previous : storage->decode(table[i])) {
+                if (reused[previous] != kNone) {
+                    files[reused[previous]].trigrams.push_back(table[i].trigram);
+                }
+            }
+        }
+    }
+
+    // New and changed files are read in parallel; unreadable ones stay unindexed
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        std::vector<uint64_t> seen(kTrigramSpace / 64, 0);
+        for (size_t i = next++; i < pending.size(); i = next++) {
+            auto& file = files[pending[i]];
+            try {
+                file.trigrams = extractTrigrams(*sources[pending[i]], seen);
+                file.indexed = true;
+            } catch (const std::exception&) {
+                std::fill(seen.begin(), seen.end(), 0);
+                file.trigrams.clear();
+            }
+        }
+    };
+
+    const size_t threadCount = std::min<size_t>(std::max(1u, options.maxParallel), pending.size());
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return TrigramIndex(std::make_shared<const Storage>(std::make_shared<const MappedFile>(serialize(files))));
+}
+
+void TrigramIndex::save(const std::filesystem::path& path) const {
+    auto temporary = path;
+    temporary += ".fsiltmp";
+
+    try {
+        std::ofstream out(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not create file: " + temporary.string());
+        }
+        out.write(storage->bytes(), static_cast<std::streamsize>(storage->byteCount()));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Could not write file: " + temporary.string());
+        }
+        std::filesystem::rename(temporary, path);
+    } catch (...) {
+        std::error_code ec;
+        std::filesystem::remove(temporary, ec);
+        throw;
+    }
+}
+
+TrigramIndex TrigramIndex::load(const std::filesystem::path& path) {
+    return TrigramIndex(std::make_shared<const Storage>(MappedFile::open(path)));
+}
+
+size_t TrigramIndex::fileCount() const {
+    return storage->fileCount();
+}
+
+size_t TrigramIndex::trigramCount() const {
+    return storage->trigramCount();
+}
+
+std::vector<uint32_t> TrigramIndex::candidateIds(const std::vector<std::string>& literals) const {
+    std::vector<uint32_t> trigrams;
+    for (const auto& literal : literals) {
+        const auto more = trigramsOf(literal);
+        trigrams.insert(trigrams.end(), more.begin(), more.end());
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    std::vector<uint32_t> ids;
+    std::vector<uint32_t> unindexed;
+    for (uint32_t id = 0; id < storage->fileCount(); ++id) {
+        if (trigrams.empty()) {
+            ids.push_back(id);
+        } else if (!(storage->file(id).flags & kIndexed)) {
+            unindexed.push_back(id);
+        }
+    }
+    if (trigrams.empty()) {
+        return ids;
+    }
+
+    // Intersect the shortest lists first; a trigram nobody has ends the search
+    std::vector<const TrigramRecord*> records;
+    for (const auto trigram : trigrams) {
+        const auto* record = storage->find(trigram);
+        if (record == nullptr) {
+            return unindexed;
+        }
+        records.push_back(record);
+    }
+    std::sort(records.begin(), records.end(), [](const TrigramRecord* a, const TrigramRecord* b) {
+        return a->fileCount < b->fileCount;
+    });
+
+    ids = storage->decode(*records.front());
+    for (size_t i = 1; i < records.size() && !ids.empty(); ++i) {
+        ids = intersect(ids, storage->decode(*records[i]));
+    }
+
+    std::vector<uint32_t> result;
+    std::set_union(ids.begin(), ids.end(), unindexed.begin(), unindexed.end(), std::back_inserter(result));
+    return result;
+}
+
+std::vector<std::filesystem::path> TrigramIndex::pathsOf(const std::vector<uint32_t>& ids) const {
+    std::vector<std::filesystem::path> paths;
+    paths.reserve(ids.size());
+    for (const auto id : ids) {
+        paths.emplace_back(storage->path(id));
+    }
+    return paths;
+}
+
+std::vector<std::filesystem::path> TrigramIndex::candidates(const std::string& literal) const {
+    return pathsOf(candidateIds({literal}));
+}
+
+std::vector<std::filesystem::path> TrigramIndex::regexCandidates(const std::string& pattern,
+                                                                 std::regex_constants::syntax_option_type flags) const {
+    // Only ECMAScript patterns are parsed; the POSIX grammars give \( \{ | + ? and newlines other meanings
+    constexpr auto otherGrammars = std::regex_constants::basic | std::regex_constants::extended |
+                                   std::regex_constants::awk | std::regex_constants::grep |
+                                   std::regex_constants::egrep;
+    if ((flags & std::regex_constants::icase) || (flags & otherGrammars)) {
+        return pathsOf(candidateIds({}));
+    }
+    return pathsOf(candidateIds(requiredLiterals(pattern)));
+}
+
+std::vector<std::filesystem::path> TrigramIndex::search(const std::string& literal) const {
+    std::vector<std::filesystem::path> matches;
+    for (auto& path : candidates(literal)) {
+        try {
+            if (containsLiteral(path, literal)) {
+                matches.push_back(std::move(path));
+            }
+        } catch (const std::exception&) {
+            // Removed or unreadable since the index was built
+        }
+    }
+    return matches;
+}
+
+std::vector<std::filesystem::path> TrigramIndex::searchRegex(const std::string& pattern,
+                                                             std::regex_constants::syntax_option_type flags) const {
+    const std::regex expression(pattern, flags);
+
+    std::vector<std::filesystem::path> matches;
+    for (auto& path : regexCandidates(pattern, flags)) {
+        try {
+            // forEachLine returns false once the callback stops it at the first matching line
+            const bool matched = !FileEntry(path).forEachLine([&expression](const std::string& line) {
+                return !std::regex_search(line, expression);
+            });
+            if (matched) {
+                matches.push_back(std::move(path));
+            }
+        } catch (const std::exception&) {
+            // Removed or unreadable since the index was built
+        }
+    }
+    return matches;
+}
+
+std::vector<std::string> TrigramIndex::requiredLiterals(const std::string& pattern) {
+    std::vector<std::string> literals;
+    std::string run;
+    auto flush = [&literals, &run]() {
+        if (!run.empty()) {
+            literals.push_back(run);
+            run.clear();
+        }
+    };
+
+    // Skips a bracket expression or a group starting at i; leaves i on its closing character
+    auto skip = [&pattern](size_t& i) {
+        int depth = 0;
+        bool inClass = false;
+        for (; i < pattern.size(); ++i) {
+            const char c = pattern[i];
+            if (c == '\\') {
+                ++i;
+            } else if (inClass) {
+                inClass = c != ']';
+            } else if (c == '[') {
+                inClass = true;
+                // A ']' right after '[' or '[^' is a member, not the end
+                if (i + 1 < pattern.size() && pattern[i + 1] == '^') {
+                    ++i;
+                }
+                if (i + 1 < pattern.size() && pattern[i + 1] == ']') {
+                    ++i;
+                }
+                if (depth == 0) {
+                    // Stand-alone class: find its end and stop there
+                    for (++i; i < pattern.size() && pattern[i] != ']'; ++i) {
+                        if (pattern[i] == '\\') {
+                            ++i;
+                        }
+                    }
+                    return;
+                }
+            } else if (c == '(') {
+                ++depth;
+            } else if (c == ')' && --depth == 0) {
+                return;
+            }
+        }
+    };
+
+    // Leaves i on the last operand of \xhh, \uhhhh, \cX, \0 and back references
+    auto skipEscapeOperands = [&pattern](size_t& i, char escaped) {
+        auto skipWhile = [&pattern, &i](size_t count, int (*accept)(int)) {
+            for (; count > 0 && i + 1 < pattern.size() && accept(static_cast<unsigned char>(pattern[i + 1])); --count) {
+                ++i;
+            }
+        };
+        if (escaped == 'x') {
+            skipWhile(2, std::isxdigit);
+        } else if (escaped == 'u') {
+            skipWhile(4, std::isxdigit);
+        } else if (escaped == 'c') {
+            skipWhile(1, std::isalpha);
+        } else if (std::isdigit(static_cast<unsigned char>(escaped))) {
+            skipWhile(std::string::npos, std::isdigit);
+        }
+    };
+
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        const char c = pattern[i];
+        switch (c) {
+            case '|':
+                // Any alternative may match; nothing is required
+                return {};
+            case '\\':
+                if (i + 1 < pattern.size()) {
+                    const char escaped = pattern[++i];
+                    if (std::isalnum(static_cast<unsigned char>(escaped))) {
+                        // \d, \w, \b, \n... end the run; escapes with operands also consume those
+                        flush();
+                        skipEscapeOperands(i, escaped);
+                    } else {
+                        run.push_back(escaped);
+                    }
+                }
+                break;
+            case '*':
+            case '?':
+            case '{':
+                // The preceding character may be absent
+                if (!run.empty()) {
+                    run.pop_back();
+                }
+                flush();
+                if (c == '{') {
+                    while (i < pattern.size() && pattern[i] != '}') {
+                        ++i;
+                    }
+                }
+                break;
+            case '[':
+            case '(':
+                flush();
+                skip(i);
+                break;
+            case '+':
+            case '.':
+            case '^':
+            case '$':
+            case ')':
+                flush();
+                break;
+            default:
+                run.push_back(c);
+        }
+    }
+    flush();
+
+    return literals;
+}
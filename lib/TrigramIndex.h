@@ -0,0 +1,81 @@
+//
+// TrigramIndex.h
+// Trigram full-text index over the contents of a scanned file set
+//
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+class FileEntryContainer;
+
+struct TrigramIndexOptions {
+    // Number of files read concurrently while building
+    unsigned maxParallel = 4;
+    // Larger files are not indexed; they are always returned as candidates
+    uintmax_t maxFileSize = 64 * 1024 * 1024;
+};
+
+// Maps every 3-byte sequence of the (decompressed) file contents to the files containing it.
+// A query is narrowed to the files holding all trigrams of its literal parts before any
+// file is opened; search() then confirms the candidates against their contents.
+//
+// The index lives in one compact buffer: a file table (path, size, modification time),
+// a sorted trigram table, and delta/varint coded posting lists. save() writes that buffer
+// as is and load() maps it, so an index is ready to query without being parsed.
+//
+// Files that changed after the index was built may be missed; update() re-reads only
+// the files whose size or modification time differ and reuses the rest.
+class TrigramIndex {
+public:
+    // An index over no files
+    TrigramIndex();
+
+    static TrigramIndex build(const FileEntryContainer& entries, const TrigramIndexOptions& options = {});
+    // A new index over entries; unchanged files keep their trigrams from this index
+    [[nodiscard]] TrigramIndex update(const FileEntryContainer& entries, const TrigramIndexOptions& options = {}) const;
+
+    // Replaces the file atomically, so readers holding the previous index keep a valid mapping
+    void save(const std::filesystem::path& path) const;
+    static TrigramIndex load(const std::filesystem::path& path);
+
+    [[nodiscard]] size_t fileCount() const;
+    [[nodiscard]] size_t trigramCount() const;
+
+    // Files that may contain the literal / match the regular expression
+    [[nodiscard]] std::vector<std::filesystem::path> candidates(const std::string& literal) const;
+    [[nodiscard]] std::vector<std::filesystem::path> regexCandidates(
+            const std::string& pattern,
+            std::regex_constants::syntax_option_type flags = std::regex_constants::ECMAScript) const;
+
+    // Files that do contain the literal / match the regular expression. Contents are streamed,
+    // never loaded whole; a regular expression is matched against one line at a time.
+    [[nodiscard]] std::vector<std::filesystem::path> search(const std::string& literal) const;
+    [[nodiscard]] std::vector<std::filesystem::path> searchRegex(
+            const std::string& pattern,
+            std::regex_constants::syntax_option_type flags = std::regex_constants::ECMAScript) const;
+
+    // Literal runs that every match of an ECMAScript pattern must contain. Conservative: a
+    // pattern with alternation yields none, and groups, classes, escapes and optional
+    // characters end a run. Patterns in the other grammars are not narrowed.
+    [[nodiscard]] static std::vector<std::string> requiredLiterals(const std::string& pattern);
+
+private:
+    class Storage;
+
+    explicit TrigramIndex(std::shared_ptr<const Storage> storage);
+
+    [[nodiscard]] std::vector<uint32_t> candidateIds(const std::vector<std::string>& literals) const;
+    [[nodiscard]] std::vector<std::filesystem::path> pathsOf(const std::vector<uint32_t>& ids) const;
+
+    std::shared_ptr<const Storage> storage;
+};
+
+#endif // TRIGRAMINDEX_H
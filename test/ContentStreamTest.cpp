@@ -0,0 +1,300 @@
+#define BOOST_TEST_MODULE ContentStreamTest
+#include <boost/test/included/unit_test.hpp>
+#include "ContentStream.h"
+#include "FileEntry.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef FSIL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef FSIL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Text with enough variation that it does not compress down to nothing
+std::string makeLines(size_t count) {
+    std::string text;
+    for (size_t i = 0; i < count; ++i) {
+        text += "line " + std::to_string(i) + " value " + std::to_string(i * 7919 % 10007) + "\n";
+    }
+    return text;
+}
+
+std::string readAll(ContentStream& stream, size_t chunkSize = 4096) {
+    std::string content;
+    std::string buffer(chunkSize, '\0');
+    while (const size_t count = stream.read(buffer.data(), buffer.size())) {
+        content.append(buffer.data(), count);
+    }
+    return content;
+}
+
+void writeFile(const fs::path& path, const std::string& data) {
+    std::ofstream(path, std::ios::binary) << data;
+}
+
+#ifdef FSIL_HAVE_ZLIB
+// One gzip member holding data
+std::string gzipMember(const std::string& data) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string output(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = output.size();
+    deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return output;
+}
+
+// BGZF: gzip members of at most 64KB, each recording its size in a BC extra field
+std::string bgzf(const std::string& data) {
+    auto appendLE = [](std::string& out, uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    };
+
+    std::string output;
+    for (size_t offset = 0; offset <= data.size(); offset += 0xff00) {
+        const std::string chunk = data.substr(offset, 0xff00);
+
+        z_stream stream{};
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+        std::string deflated(deflateBound(&stream, chunk.size()), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(chunk.data()));
+        stream.avail_in = chunk.size();
+        stream.next_out = reinterpret_cast<Bytef*>(deflated.data());
+        stream.avail_out = deflated.size();
+        deflate(&stream, Z_FINISH);
+        deflated.resize(stream.total_out);
+        deflateEnd(&stream);
+
+        std::string block = std::string("\x1f\x8b\x08\x04\0\0\0\0\0\xff\x06\0BC\x02\0", 16);
+        appendLE(block, static_cast<uint32_t>(18 + deflated.size() + 8 - 1), 2);
+        block += deflated;
+        appendLE(block, crc32(0, reinterpret_cast<const Bytef*>(chunk.data()), chunk.size()), 4);
+        appendLE(block, static_cast<uint32_t>(chunk.size()), 4);
+        output += block;
+    }
+    return output;
+}
+#endif
+
+#ifdef FSIL_HAVE_ZSTD
+std::string zstdFrame(const std::string& data) {
+    std::string output(ZSTD_compressBound(data.size()), '\0');
+    output.resize(ZSTD_compress(output.data(), output.size(), data.data(), data.size(), 3));
+    return output;
+}
+
+// A frame without a declared content size, as produced by streaming compressors
+std::string zstdStreamedFrame(const std::string& data) {
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    std::string output(ZSTD_compressBound(data.size()) + 64, '\0');
+    ZSTD_inBuffer in{data.data(), data.size(), 0};
+    ZSTD_outBuffer out{output.data(), output.size(), 0};
+    ZSTD_compressStream2(context, &out, &in, ZSTD_e_end);
+    output.resize(out.pos);
+    ZSTD_freeCCtx(context);
+    return output;
+}
+#endif
+
+// Reads the stream through a small buffer; returns the largest amount of decoded data buffered ahead
+size_t peakBuffered(ContentStream& stream, uintmax_t& total) {
+    std::vector<char> buffer(64 * 1024);
+    size_t peak = 0;
+    total = 0;
+    while (const size_t count = stream.read(buffer.data(), buffer.size())) {
+        total += count;
+        peak = std::max(peak, stream.bufferedBytes());
+    }
+    return peak;
+}
+
+// Fixture for setting up and tearing down test resources
+struct TestFixture {
+    TestFixture() {
+        testDataPath = fs::temp_directory_path() / "content_stream_testdata";
+        fs::create_directories(testDataPath);
+    }
+
+    ~TestFixture() {
+        fs::remove_all(testDataPath);
+    }
+
+    fs::path testDataPath;
+};
+
+BOOST_FIXTURE_TEST_SUITE(ContentStreamSuite, TestFixture)
+
+BOOST_AUTO_TEST_CASE(RawContent) {
+    const auto path = testDataPath / "plain.txt";
+    writeFile(path, "Line 1\nLine 2\n");
+
+    BOOST_TEST((ContentStream::detectFormat(path) == ContentStream::Format::Raw));
+    auto stream = ContentStream::open(path);
+    BOOST_TEST(readAll(*stream) == "Line 1\nLine 2\n");
+}
+
+BOOST_AUTO_TEST_CASE(MissingFileThrows) {
+    BOOST_CHECK_THROW(ContentStream::open(testDataPath / "missing.gz"), std::runtime_error);
+}
+
+#ifdef FSIL_HAVE_ZLIB
+BOOST_AUTO_TEST_CASE(GzipMultiMember) {
+    const auto path = testDataPath / "multi.log.gz";
+    const std::string first = makeLines(1000);
+    const std::string second = makeLines(50);
+    writeFile(path, gzipMember(first) + gzipMember(second));
+
+    BOOST_TEST((ContentStream::detectFormat(path) == ContentStream::Format::Gzip));
+    auto stream = ContentStream::open(path);
+    BOOST_TEST(readAll(*stream, 1000) == first + second);
+}
+
+BOOST_AUTO_TEST_CASE(GzipTruncatedThrows) {
+    const auto path = testDataPath / "truncated.log.gz";
+    const std::string compressed = gzipMember(makeLines(1000));
+    writeFile(path, compressed.substr(0, compressed.size() / 2));
+
+    auto stream = ContentStream::open(path);
+    BOOST_CHECK_THROW(readAll(*stream), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(BgzfParallel) {
+    const auto path = testDataPath / "blocks.log.gz";
+    const std::string text = makeLines(200000);
+    writeFile(path, bgzf(text));
+
+    BOOST_TEST((ContentStream::detectFormat(path) == ContentStream::Format::Bgzf));
+    auto stream = ContentStream::open(path, 4);
+    BOOST_TEST(readAll(*stream, 100000) == text);
+}
+
+BOOST_AUTO_TEST_CASE(BgzfCompressibleStaysBounded) {
+    const auto path = testDataPath / "zeros.gz";
+    // Compresses to about 100 KB: a single batch of input would inflate to all 64 MB
+    writeFile(path, bgzf(std::string(64 * 1024 * 1024, '\0')));
+
+    auto stream = ContentStream::open(path, 4);
+    uintmax_t total = 0;
+    const size_t peak = peakBuffered(*stream, total);
+    BOOST_TEST(total == 64u * 1024 * 1024);
+    // At most 4 MB per batch in flight, plus the one being handed out
+    BOOST_TEST(peak <= 5u * 4 * 1024 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(BgzfOversizedBlockThrows) {
+    const auto path = testDataPath / "oversized.gz";
+    std::string compressed = bgzf("Line 1\n");
+    // ISIZE of the (only) block claims 4 GB
+    compressed.replace(compressed.size() - 4, 4, "\xff\xff\xff\xff", 4);
+    writeFile(path, compressed);
+
+    auto stream = ContentStream::open(path);
+    BOOST_CHECK_THROW(readAll(*stream), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(FileEntryDecompressesTransparently) {
+    const auto path = testDataPath / "entry.log.gz";
+    writeFile(path, gzipMember("Line 1\nLine 2\nLine 3"));
+
+    FileEntry entry(path);
+    BOOST_TEST(entry.getContent() == "Line 1\nLine 2\nLine 3");
+    BOOST_TEST(entry.getRawContent().size() == fs::file_size(path));
+
+    const auto lines = entry.getLines();
+    BOOST_TEST(lines.size() == 3);
+    BOOST_TEST(lines[2] == "Line 3");
+
+    // Iteration stops as soon as the callback asks to
+    size_t seen = 0;
+    BOOST_TEST(!entry.forEachLine([&seen](const std::string&) { return ++seen < 2; }));
+    BOOST_TEST(seen == 2);
+}
+#endif
+
+#ifdef FSIL_HAVE_ZSTD
+BOOST_AUTO_TEST_CASE(ZstdMultiFrameParallel) {
+    const auto path = testDataPath / "frames.log.zst";
+    std::string text;
+    std::string compressed;
+    for (size_t i = 0; i < 40; ++i) {
+        const std::string part = makeLines(5000 + i);
+        text += part;
+        compressed += zstdFrame(part);
+    }
+    writeFile(path, compressed);
+
+    BOOST_TEST((ContentStream::detectFormat(path) == ContentStream::Format::Zstd));
+    auto stream = ContentStream::open(path, 4);
+    BOOST_TEST(readAll(*stream, 65536) == text);
+}
+
+BOOST_AUTO_TEST_CASE(ZstdStreamedFrame) {
+    const auto path = testDataPath / "streamed.log.zst";
+    const std::string text = makeLines(100000);
+    writeFile(path, zstdStreamedFrame(text) + zstdStreamedFrame(text));
+
+    auto stream = ContentStream::open(path);
+    BOOST_TEST(readAll(*stream) == text + text);
+}
+
+// Like `cat small.zst big.zst`: frames too large to buffer are streamed between parallel ones
+BOOST_AUTO_TEST_CASE(ZstdMixedFrames) {
+    const auto path = testDataPath / "mixed.log.zst";
+    const std::string small = makeLines(1000);
+    const std::string unsized = makeLines(200000);
+    const std::string oversized(40 * 1024 * 1024, 'x');
+    writeFile(path, zstdFrame(small) + zstdStreamedFrame(unsized) + zstdFrame(small) + zstdFrame(oversized) +
+                    zstdFrame(small));
+
+    auto stream = ContentStream::open(path, 4);
+    BOOST_TEST((readAll(*stream, 100000) == small + unsized + small + oversized + small));
+}
+
+BOOST_AUTO_TEST_CASE(ZstdCompressibleStaysBounded) {
+    const auto path = testDataPath / "zeros.zst";
+    // Sized frames of zeros: 200 x 1 MB in parallel, then 24 x 32 MB streamed
+    const std::string small = zstdFrame(std::string(1024 * 1024, '\0'));
+    const std::string large = zstdFrame(std::string(32 * 1024 * 1024, '\0'));
+    std::string compressed;
+    for (size_t i = 0; i < 200; ++i) {
+        compressed += small;
+    }
+    for (size_t i = 0; i < 24; ++i) {
+        compressed += large;
+    }
+    writeFile(path, compressed);
+
+    for (unsigned threads : {1u, 4u}) {
+        auto stream = ContentStream::open(path, threads);
+        uintmax_t total = 0;
+        const size_t peak = peakBuffered(*stream, total);
+        BOOST_TEST(total == 968u * 1024 * 1024);
+        BOOST_TEST(peak <= (threads + 1) * 4u * 1024 * 1024);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ZstdTruncatedThrows) {
+    const auto path = testDataPath / "truncated.log.zst";
+    const std::string compressed = zstdStreamedFrame(makeLines(100000));
+    writeFile(path, compressed.substr(0, compressed.size() / 2));
+
+    auto stream = ContentStream::open(path);
+    BOOST_CHECK_THROW(readAll(*stream), std::runtime_error);
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
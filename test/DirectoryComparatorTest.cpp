@@ -0,0 +1,109 @@
+#define BOOST_TEST_MODULE DirectoryComparatorTest
+#include <boost/test/included/unit_test.hpp>
+#include "DirectoryComparator.h"
+#include "FileScanner.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+// Fixture with a source tree and an identical replica made by FileCopier
+struct TestFixture {
+    TestFixture() {
+        sourcePath = fs::temp_directory_path() / "directory_comparator_source";
+        replicaPath = fs::temp_directory_path() / "directory_comparator_replica";
+        fs::remove_all(replicaPath);
+
+        fs::create_directories(sourcePath / "folder1");
+        fs::create_directories(sourcePath / "folder2/nested");
+
+        std::ofstream(sourcePath / "folder1/file1.txt") << "File 1 content";
+        std::ofstream(sourcePath / "folder1/file2.log") << "File 2 content";
+        std::ofstream(sourcePath / "folder2/nested/subfile1.txt") << "Subfile 1 content";
+        std::ofstream(sourcePath / "top.txt") << "Top content";
+
+        FileEntryContainer entries;
+        FileScanner::getInstance().scan(sourcePath, entries, [](const fs::path&) { return true; }, true);
+        entries.copyTo(sourcePath, replicaPath);
+    }
+
+    ~TestFixture() {
+        fs::remove_all(sourcePath);
+        fs::remove_all(replicaPath);
+    }
+
+    fs::path sourcePath;
+    fs::path replicaPath;
+};
+
+BOOST_FIXTURE_TEST_SUITE(DirectoryComparatorSuite, TestFixture)
+
+BOOST_AUTO_TEST_CASE(IdenticalTrees) {
+    const auto diff = DirectoryComparator().compare(sourcePath, replicaPath);
+    BOOST_TEST(diff.identical());
+}
+
+BOOST_AUTO_TEST_CASE(AddedRemovedAndChanged) {
+    std::ofstream(replicaPath / "folder1/extra.txt") << "Extra";
+    fs::remove(replicaPath / "folder2/nested/subfile1.txt");
+    std::ofstream(replicaPath / "top.txt") << "Different length";
+    fs::create_directories(replicaPath / "folder3/deep");
+
+    const auto diff = DirectoryComparator().compare(sourcePath, replicaPath);
+
+    BOOST_TEST(diff.added.size() == 2);
+    BOOST_TEST(diff.added[0] == fs::path("folder1/extra.txt"));
+    BOOST_TEST(diff.added[1] == fs::path("folder3"));
+    BOOST_TEST(diff.removed.size() == 1);
+    BOOST_TEST(diff.removed[0] == fs::path("folder2/nested/subfile1.txt"));
+    BOOST_TEST(diff.changed.size() == 1);
+    BOOST_TEST(diff.changed[0] == fs::path("top.txt"));
+}
+
+BOOST_AUTO_TEST_CASE(ContentDecidesWhenOnlyTimeDiffers) {
+    const auto touched = replicaPath / "folder1/file1.txt";
+    fs::last_write_time(touched, fs::file_time_type::clock::now() - std::chrono::hours(1));
+
+    // Same bytes: only a content check can tell it is unchanged
+    BOOST_TEST(DirectoryComparator().compare(sourcePath, replicaPath).identical());
+
+    CompareOptions metadataOnly;
+    metadataOnly.contentCheck = ContentCheck::Never;
+    BOOST_TEST(DirectoryComparator(metadataOnly).compare(sourcePath, replicaPath).changed.size() == 1);
+
+    // Same size, different bytes, different time
+    std::ofstream(touched) << "File 1 CONTENT";
+    fs::last_write_time(touched, fs::file_time_type::clock::now() - std::chrono::hours(1));
+    const auto diff = DirectoryComparator().compare(sourcePath, replicaPath);
+    BOOST_TEST(diff.changed.size() == 1);
+    BOOST_TEST(diff.changed[0] == fs::path("folder1/file1.txt"));
+}
+
+BOOST_AUTO_TEST_CASE(AlwaysCheckContent) {
+    // Same size and time, different bytes: only found when contents are always compared
+    const auto sourceFile = sourcePath / "folder1/file2.log";
+    const auto replicaFile = replicaPath / "folder1/file2.log";
+    std::ofstream(replicaFile) << "File 2 CONTENT";
+    fs::last_write_time(replicaFile, fs::last_write_time(sourceFile));
+
+    BOOST_TEST(DirectoryComparator().compare(sourcePath, replicaPath).identical());
+
+    CompareOptions always;
+    always.contentCheck = ContentCheck::Always;
+    BOOST_TEST(DirectoryComparator(always).compare(sourcePath, replicaPath).changed.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(TypeMismatchAndSameTree) {
+    fs::remove(replicaPath / "top.txt");
+    fs::create_directory(replicaPath / "top.txt");
+
+    const auto diff = DirectoryComparator().compare(sourcePath, replicaPath);
+    BOOST_TEST(diff.changed.size() == 1);
+    BOOST_TEST(diff.changed[0] == fs::path("top.txt"));
+
+    // A tree compared with itself is short-circuited at the root
+    BOOST_TEST(DirectoryComparator().compare(sourcePath, sourcePath).identical());
+    BOOST_CHECK_THROW(DirectoryComparator().compare(sourcePath, sourcePath / "missing"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,119 @@
+#define BOOST_TEST_MODULE FileCopierTest
+#include <boost/test/included/unit_test.hpp>
+#include "FileCopier.h"
+#include "FileScanner.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Fixture for setting up and tearing down test resources
+struct TestFixture {
+    TestFixture() {
+        sourcePath = fs::temp_directory_path() / "file_copier_source";
+        destinationPath = fs::temp_directory_path() / "file_copier_destination";
+        fs::remove_all(destinationPath);
+
+        fs::create_directories(sourcePath / "folder1");
+        fs::create_directories(sourcePath / "folder2/nested");
+
+        std::ofstream(sourcePath / "folder1/file1.txt") << "File 1 content";
+        std::ofstream(sourcePath / "folder1/file2.log") << std::string(3 * 1024 * 1024, 'x');
+        std::ofstream(sourcePath / "folder2/nested/subfile1.txt") << "Subfile 1 content";
+        fs::permissions(sourcePath / "folder1/file1.txt", fs::perms::owner_read | fs::perms::owner_write);
+
+        FileScanner::getInstance().scan(sourcePath, entries, [](const fs::path&) { return true; }, true);
+    }
+
+    ~TestFixture() {
+        fs::remove_all(sourcePath);
+        fs::remove_all(destinationPath);
+    }
+
+    fs::path sourcePath;
+    fs::path destinationPath;
+    FileEntryContainer entries;
+};
+
+BOOST_FIXTURE_TEST_SUITE(FileCopierSuite, TestFixture)
+
+BOOST_AUTO_TEST_CASE(CopiesTreeWithMetadata) {
+    const auto stats = entries.copyTo(sourcePath, destinationPath);
+
+    BOOST_TEST(stats.filesCopied == 3);
+    BOOST_TEST(stats.filesFailed == 0);
+    BOOST_TEST(stats.bytesCopied == 14 + 3 * 1024 * 1024 + 17);
+
+    entries.foreach([this](const FileEntry& entry) {
+        const FileEntry copy(destinationPath / entry.getPath().lexically_relative(sourcePath));
+        BOOST_TEST(copy.exists());
+        BOOST_TEST(copy.hasSameContent(entry));
+        BOOST_TEST((copy.getModificationTime() == entry.getModificationTime()));
+        BOOST_TEST((copy.getPermissions() == entry.getPermissions()));
+        return true;
+    });
+}
+
+BOOST_AUTO_TEST_CASE(SkipsUpToDateTargets) {
+    entries.copyTo(sourcePath, destinationPath);
+
+    std::ofstream(sourcePath / "folder1/file1.txt", std::ios::app) << " changed";
+
+    const auto stats = entries.copyTo(sourcePath, destinationPath);
+    BOOST_TEST(stats.filesCopied == 1);
+    BOOST_TEST(stats.filesSkipped == 2);
+    BOOST_TEST(FileEntry(destinationPath / "folder1/file1.txt").getContent() == "File 1 content changed");
+}
+
+BOOST_AUTO_TEST_CASE(ContentPolicyIgnoresTimestamps) {
+    entries.copyTo(sourcePath, destinationPath);
+    fs::last_write_time(destinationPath / "folder1/file1.txt", fs::file_time_type::clock::now() - std::chrono::hours(1));
+
+    CopyOptions options;
+    options.skipPolicy = SkipPolicy::Content;
+    BOOST_TEST(entries.copyTo(sourcePath, destinationPath, options).filesSkipped == 3);
+
+    options.skipPolicy = SkipPolicy::Never;
+    BOOST_TEST(entries.copyTo(sourcePath, destinationPath, options).filesCopied == 3);
+}
+
+BOOST_AUTO_TEST_CASE(ReplacesExistingTargets) {
+    // New targets are written in place, existing ones through a temporary file; neither leaves one behind
+    fs::create_directories(destinationPath / "folder1");
+    std::ofstream(destinationPath / "folder1/file1.txt") << "Stale";
+
+    CopyOptions options;
+    options.skipPolicy = SkipPolicy::Never;
+    BOOST_TEST(entries.copyTo(sourcePath, destinationPath, options).filesCopied == 3);
+    BOOST_TEST(FileEntry(destinationPath / "folder1/file1.txt").getContent() == "File 1 content");
+
+    size_t files = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(destinationPath)) {
+        BOOST_TEST(entry.path().extension() != ".fsiltmp");
+        files += entry.is_regular_file() ? 1 : 0;
+    }
+    BOOST_TEST(files == 3);
+}
+
+BOOST_AUTO_TEST_CASE(ReportsProgressAndFailures) {
+    FileEntryContainer outside(std::move(entries));
+    outside.append(fs::temp_directory_path() / "not_below_source.txt");
+
+    size_t calls = 0;
+    CopyOptions options;
+    options.maxParallel = 2;
+    options.progress = [&calls](const CopyStats& stats) {
+        ++calls;
+        BOOST_TEST(stats.filesCopied + stats.filesSkipped + stats.filesFailed == calls);
+    };
+
+    const auto stats = outside.copyTo(sourcePath, destinationPath, options);
+    BOOST_TEST(calls == 4);
+    BOOST_TEST(stats.filesCopied == 3);
+    BOOST_TEST(stats.filesFailed == 1);
+    BOOST_TEST(stats.errors.size() == 1);
+    BOOST_TEST(stats.bytesPerSecond() > 0.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,6 +1,8 @@
 #define BOOST_TEST_MODULE FileEntryContainerTest
 #include <boost/test/included/unit_test.hpp>
 #include "FileEntryContainer.h"
+#include <algorithm>
+#include <fstream>
 
 namespace fs = std::filesystem;
 
@@ -126,6 +128,207 @@ BOOST_AUTO_TEST_CASE(MoveConstructor) {
     BOOST_TEST(original.size() == 0);
 }
 
+BOOST_AUTO_TEST_CASE(IndexByExtension) {
+    FileEntryContainer container;
+    container.enableIndex(IndexType::Extension);
+
+    // Entries appended after the index is enabled are indexed too
+    for (const auto& path : testFilePaths) {
+        container.append(path);
+    }
+
+    auto txtFiles = container.findByExtension(".txt");
+    BOOST_TEST(txtFiles.size() == 2);
+    for (const auto& entry : txtFiles) {
+        BOOST_TEST(entry.getPath().extension() == ".txt");
+    }
+    BOOST_TEST(container.findByExtension(".parquet").empty());
+}
+
+BOOST_AUTO_TEST_CASE(IndexBySize) {
+    const auto largePath = fs::temp_directory_path() / "test_file_large.bin";
+    std::ofstream(largePath) << std::string(4096, 'x');
+
+    FileEntryContainer container({
+        FileEntry(testFilePaths[0]),
+        FileEntry(largePath)
+    });
+    container.enableIndex(IndexType::Size);
+
+    auto large = container.findBySize(1024, 8192);
+    BOOST_TEST(large.size() == 1);
+    BOOST_TEST(large.begin()->getPath() == largePath);
+
+    // Bounds are inclusive
+    BOOST_TEST(container.findBySize(12, 12).size() == 1);
+    BOOST_TEST(container.findBySize(0, UINTMAX_MAX).size() == 2);
+    BOOST_TEST(container.findBySize(8192, 1024).empty());
+
+    fs::remove(largePath);
+}
+
+BOOST_AUTO_TEST_CASE(IndexByModificationTime) {
+    FileEntryContainer container({
+        FileEntry(testFilePaths[0]),
+        FileEntry(testFilePaths[1])
+    });
+    container.enableIndex(IndexType::ModificationTime);
+
+    const auto oldTime = fs::file_time_type::clock::now() - std::chrono::hours(48);
+    fs::last_write_time(testFilePaths[1], oldTime);
+    container.rebuildIndexes();
+
+    const auto now = fs::file_time_type::clock::now();
+    auto recent = container.findByModificationTime(now - std::chrono::hours(1), now + std::chrono::hours(1));
+    BOOST_TEST(recent.size() == 1);
+    BOOST_TEST(recent.begin()->getPath() == testFilePaths[0]);
+}
+
+BOOST_AUTO_TEST_CASE(IndexByNamePrefix) {
+    FileEntryContainer container({
+        FileEntry(testFilePaths[0]),
+        FileEntry(testFilePaths[1]),
+        FileEntry(testFilePaths[2])
+    });
+    container.enableIndex(IndexType::NamePrefix);
+
+    BOOST_TEST(container.findByNamePrefix("test_file").size() == 3);
+    BOOST_TEST(container.findByNamePrefix("test_file2").size() == 1);
+    BOOST_TEST(container.findByNamePrefix("").size() == 3);
+    BOOST_TEST(container.findByNamePrefix("other").empty());
+}
+
+BOOST_AUTO_TEST_CASE(IndexSurvivesSortAndMove) {
+    FileEntryContainer container({
+        FileEntry(testFilePaths[2]),
+        FileEntry(testFilePaths[0])
+    });
+    container.enableIndex(IndexType::Extension);
+    container.sortFileEntriesAlphabetically();
+
+    FileEntryContainer moved(std::move(container));
+    BOOST_TEST(moved.hasIndex(IndexType::Extension));
+    BOOST_TEST(moved.findByExtension(".txt").size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(ReplaceUpdatesIndexes) {
+    FileEntryContainer container({
+        FileEntry(testFilePaths[0]),
+        FileEntry(testFilePaths[1])
+    });
+    container.enableIndex(IndexType::Extension);
+    container.enableIndex(IndexType::NamePrefix);
+
+    container.replace(0, FileEntry(testFilePaths[2]));
+    BOOST_TEST(container[0]->getPath() == testFilePaths[2]);
+    BOOST_TEST(container.findByExtension(".txt").size() == 1);
+    BOOST_TEST(container.findByExtension(".txt").begin()->getPath() == testFilePaths[2]);
+    BOOST_TEST(container.findByNamePrefix("test_file1").empty());
+    BOOST_CHECK_THROW(container.replace(2, FileEntry(testFilePaths[0])), std::out_of_range);
+
+    // Assigning through operator[](int) bypasses the indexes until they are rebuilt
+    container[1] = FileEntry::newEntry(testFilePaths[0]);
+    container.rebuildIndexes();
+    BOOST_TEST(container.findByExtension(".log").empty());
+    BOOST_TEST(container.findByExtension(".txt").size() == 2);
+    BOOST_TEST(container.findByNamePrefix("test_file1").begin()->getPath() == testFilePaths[0]);
+}
+
+BOOST_AUTO_TEST_CASE(QueryWithoutIndexThrows) {
+    FileEntryContainer container({FileEntry(testFilePaths[0])});
+
+    BOOST_TEST(!container.hasIndex(IndexType::Size));
+    BOOST_CHECK_THROW(container.findBySize(0, 100), std::runtime_error);
+
+    container.enableIndex(IndexType::Size);
+    container.disableIndex(IndexType::Size);
+    BOOST_CHECK_THROW(container.findBySize(0, 100), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(FetchMetadataInInodeOrder) {
+    FileEntryContainer container({
+        FileEntry(testFilePaths[2]),
+        FileEntry(testFilePaths[0]),
+        FileEntry(testFilePaths[1]),
+        FileEntry(fs::temp_directory_path() / "test_file_missing.txt")
+    });
+
+    std::vector<uint64_t> inodes;
+    container.fetchMetadata([&inodes](const FileEntry& entry, const FileMetadata& metadata) {
+        BOOST_TEST(metadata.size == entry.getSize());
+        inodes.push_back(metadata.inode);
+        return true;
+    }, AccessOrder::Inode);
+
+    // The missing file is skipped
+    BOOST_TEST(inodes.size() == 3);
+    BOOST_TEST(std::is_sorted(inodes.begin(), inodes.end()));
+}
+
+BOOST_AUTO_TEST_CASE(InodeOrderKeysOnDevice) {
+    // Inode numbers are only unique per device; a second filesystem is needed to tell
+    const fs::path otherDevice = "/dev/shm";
+    std::error_code error;
+    if (!fs::is_directory(otherDevice, error) ||
+        FileEntry(otherDevice).getMetadata().device == FileEntry(fs::temp_directory_path()).getMetadata().device) {
+        BOOST_TEST_MESSAGE("No second device available, skipping");
+        return;
+    }
+
+    std::vector<fs::path> paths;
+    for (size_t i = 0; i < 4; ++i) {
+        paths.push_back(otherDevice / ("fsil_inode_order_" + std::to_string(i) + ".txt"));
+        std::ofstream(paths.back()) << "Test content";
+    }
+    FileEntryContainer container({
+        FileEntry(paths[0]),
+        FileEntry(testFilePaths[0]),
+        FileEntry(paths[1]),
+        FileEntry(testFilePaths[1]),
+        FileEntry(paths[2]),
+        FileEntry(testFilePaths[2]),
+        FileEntry(paths[3])
+    });
+
+    std::vector<std::pair<uint64_t, uint64_t>> keys;
+    container.fetchMetadata([&keys](const FileEntry&, const FileMetadata& metadata) {
+        keys.emplace_back(metadata.device, metadata.inode);
+        return true;
+    }, AccessOrder::Inode);
+
+    for (const auto& path : paths) {
+        fs::remove(path);
+    }
+    BOOST_TEST(keys.size() == 7);
+    BOOST_TEST(std::is_sorted(keys.begin(), keys.end()));
+}
+
+BOOST_AUTO_TEST_CASE(ReadContentsInEveryOrder) {
+    FileEntryContainer container({
+        FileEntry(testFilePaths[0]),
+        FileEntry(testFilePaths[1]),
+        FileEntry(testFilePaths[2])
+    });
+
+    for (auto order : {AccessOrder::Container, AccessOrder::Inode, AccessOrder::PhysicalOffset}) {
+        std::vector<fs::path> visited;
+        BOOST_TEST(container.readContents([&visited](const FileEntry& entry, const std::string& content) {
+            BOOST_TEST(content == "Test content");
+            visited.push_back(entry.getPath());
+            return true;
+        }, order));
+
+        std::sort(visited.begin(), visited.end());
+        BOOST_TEST(visited.size() == 3);
+        BOOST_TEST((std::adjacent_find(visited.begin(), visited.end()) == visited.end()));
+    }
+
+    // Stops when the callback asks to
+    size_t reads = 0;
+    BOOST_TEST(!container.readContents([&reads](const FileEntry&, const std::string&) { return ++reads < 2; }));
+    BOOST_TEST(reads == 2);
+}
+
 //  TODO: Do this
 
 BOOST_AUTO_TEST_SUITE_END()
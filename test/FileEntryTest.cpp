@@ -104,4 +104,33 @@ BOOST_AUTO_TEST_CASE(FileEntryCreation) {
     BOOST_CHECK(fileVec[1]->getPath() == tempFile2.getPath());
 }
 
+BOOST_AUTO_TEST_CASE(FileMetadataRetrieval) {
+    TempFile tempFile("This is a test file.");
+    FileEntry fileEntry(tempFile.getPath());
+
+    // A single stat yields the same values as the individual accessors
+    const auto metadata = fileEntry.getMetadata();
+    BOOST_CHECK_EQUAL(metadata.size, fileEntry.getSize());
+    BOOST_CHECK(metadata.modificationTime == fileEntry.getModificationTime());
+    BOOST_CHECK(metadata.permissions == fileEntry.getPermissions());
+    BOOST_CHECK(metadata.type == fs::file_type::regular);
+
+    BOOST_CHECK(!FileEntry::readMetadata(tempFile.getPath().parent_path() / "missing_file.txt"));
+}
+
+BOOST_AUTO_TEST_CASE(FileContentComparison) {
+    TempFile tempFile("This is a test file.");
+    const auto samePath = fs::temp_directory_path() / "test_file_same.txt";
+    const auto otherPath = fs::temp_directory_path() / "test_file_other.txt";
+    std::ofstream(samePath) << "This is a test file.";
+    std::ofstream(otherPath) << "This is a test file!";
+
+    FileEntry fileEntry(tempFile.getPath());
+    BOOST_CHECK(fileEntry.hasSameContent(FileEntry(samePath)));
+    BOOST_CHECK(!fileEntry.hasSameContent(FileEntry(otherPath)));
+
+    fs::remove(samePath);
+    fs::remove(otherPath);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
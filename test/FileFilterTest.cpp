@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE FileFilterTest
+#include <boost/test/included/unit_test.hpp>
+#include "FileFilter.h"
+#include "FileScanner.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace FileFilter;
+using namespace FileFilter::literals;
+
+// Clause which pretends to need a stat and counts how often it is evaluated
+class CountingSizeClause : public Expression<CountingSizeClause> {
+public:
+    static constexpr unsigned needs = NeedSize;
+
+    explicit CountingSizeClause(int& counter) : counter(&counter) {}
+
+    [[nodiscard]] bool test(const Candidate&) const {
+        ++*counter;
+        return true;
+    }
+
+private:
+    int* counter;
+};
+
+// Fixture for setting up and tearing down test resources
+struct TestFixture {
+    TestFixture() {
+        testDataPath = fs::temp_directory_path() / "file_filter_testdata";
+        fs::create_directories(testDataPath);
+
+        std::ofstream(testDataPath / "small.log") << "tiny";
+        std::ofstream(testDataPath / "large.log") << std::string(2048, 'x');
+        std::ofstream(testDataPath / "large.tmp.log") << std::string(2048, 'x');
+        std::ofstream(testDataPath / "notes.txt") << std::string(4096, 'x');
+    }
+
+    ~TestFixture() {
+        fs::remove_all(testDataPath);
+    }
+
+    fs::path testDataPath;
+};
+
+BOOST_FIXTURE_TEST_SUITE(FileFilterSuite, TestFixture)
+
+BOOST_AUTO_TEST_CASE(GlobMatching) {
+    BOOST_TEST(globMatch("*.tmp", "file.tmp"));
+    BOOST_TEST(globMatch("*.tmp*", "file.tmp.log"));
+    BOOST_TEST(globMatch("file?.txt", "file1.txt"));
+    BOOST_TEST(globMatch("*", ""));
+    BOOST_TEST(!globMatch("*.tmp", "file.tmp.log"));
+    BOOST_TEST(!globMatch("file?.txt", "file.txt"));
+}
+
+BOOST_AUTO_TEST_CASE(SizeLiterals) {
+    BOOST_TEST(1_KB == 1024u);
+    BOOST_TEST(1_MB == 1024u * 1024u);
+    BOOST_TEST(2_GB == 2ULL * 1024u * 1024u * 1024u);
+}
+
+BOOST_AUTO_TEST_CASE(NameClausesEvaluatedBeforeStat) {
+    int evaluations = 0;
+    auto filter = CountingSizeClause(evaluations) && ext(".txt");
+
+    // The extension clause rejects the file before the size clause is consulted
+    BOOST_TEST(!filter(fs::directory_entry(testDataPath / "small.log")));
+    BOOST_TEST(evaluations == 0);
+
+    BOOST_TEST(filter(fs::directory_entry(testDataPath / "notes.txt")));
+    BOOST_TEST(evaluations == 1);
+}
+
+BOOST_AUTO_TEST_CASE(ComposedExpression) {
+    auto filter = ext(".log") && size_gt(1_KB) && !name_glob("*.tmp*");
+
+    BOOST_TEST(filter(testDataPath / "large.log"));
+    BOOST_TEST(!filter(testDataPath / "small.log"));
+    BOOST_TEST(!filter(testDataPath / "large.tmp.log"));
+    BOOST_TEST(!filter(testDataPath / "notes.txt"));
+}
+
+BOOST_AUTO_TEST_CASE(ModificationTimeClauses) {
+    const auto past = fs::file_time_type::clock::now() - std::chrono::hours(1);
+    const auto future = fs::file_time_type::clock::now() + std::chrono::hours(1);
+
+    BOOST_TEST((mtime_after(past) && mtime_before(future))(testDataPath / "notes.txt"));
+    BOOST_TEST(!mtime_after(future)(testDataPath / "notes.txt"));
+}
+
+BOOST_AUTO_TEST_CASE(MissingFileFailsMetadataClauses) {
+    BOOST_TEST(!size_gt(0)(testDataPath / "missing.log"));
+    BOOST_TEST(!size_lt(1_GB)(testDataPath / "missing.log"));
+    BOOST_TEST(ext(".log")(testDataPath / "missing.log"));
+
+    // Negation does not turn a failed stat into a match
+    BOOST_TEST(!(!size_gt(1_KB))(testDataPath / "missing.log"));
+    BOOST_TEST(!(ext(".log") && !mtime_after(fs::file_time_type::min()))(testDataPath / "missing.log"));
+    BOOST_TEST(!(!(size_gt(1_KB) || ext(".txt")))(testDataPath / "missing.log"));
+    BOOST_TEST((!size_gt(1_KB))(testDataPath / "small.log"));
+}
+
+BOOST_AUTO_TEST_CASE(ScanWithFilterExpression) {
+    FileScanner& scanner = FileScanner::getInstance();
+    FileEntryContainer entries;
+
+    auto isLarge = where([](const fs::path& path) { return path.stem().string().rfind("large", 0) == 0; });
+    scanner.scan(testDataPath, entries, (ext(".log") || ext(".txt")) && size_gt(1_KB) && !isLarge, false);
+
+    BOOST_TEST(entries.size() == 1);
+    BOOST_TEST(entries[0]->getPath().filename().string() == "notes.txt");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
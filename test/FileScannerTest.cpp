@@ -122,4 +122,114 @@ BOOST_FIXTURE_TEST_CASE(ScanWithFileEntryContainer, TestFixture) {
     BOOST_TEST(entries[1]->getPath().filename().string() == "subfile2.log");
 }
 
+BOOST_FIXTURE_TEST_CASE(ScanWithMaxDepth, TestFixture) {
+    FileScanner& scanner = FileScanner::getInstance();
+    fs::create_directories(testDataPath / "folder2/deep");
+    std::ofstream(testDataPath / "folder2/deep/deepfile.txt") << "Deep content";
+
+    ScanOptions options;
+    options.recursive = true;
+    options.maxDepth = 1;
+
+    FileEntryContainer entries;
+    BOOST_TEST(scanner.scan(testDataPath, entries, [](const fs::path&) { return true; }, options));
+    BOOST_TEST(entries.size() == 4);
+
+    options.maxDepth = -1;
+    FileEntryContainer allEntries;
+    scanner.scan(testDataPath, allEntries, [](const fs::path&) { return true; }, options);
+    BOOST_TEST(allEntries.size() == 5);
+}
+
+BOOST_FIXTURE_TEST_CASE(ScanWithMaxEntries, TestFixture) {
+    FileScanner& scanner = FileScanner::getInstance();
+
+    ScanOptions options;
+    options.recursive = true;
+    options.maxEntries = 3;
+
+    // 2 folders + 4 files: the budget runs out part way
+    FileEntryVec entries;
+    BOOST_TEST(!scanner.scan(testDataPath, entries, std::vector<std::string>{R"(.*)"}, options));
+    BOOST_TEST(entries.size() < 4);
+
+    options.maxEntries = 6;
+    FileEntryVec allEntries;
+    BOOST_TEST(scanner.scan(testDataPath, allEntries, std::vector<std::string>{R"(.*)"}, options));
+    BOOST_TEST(allEntries.size() == 4);
+}
+
+BOOST_FIXTURE_TEST_CASE(ScanWithSymlinkPolicies, TestFixture) {
+    FileScanner& scanner = FileScanner::getInstance();
+    auto all = [](const fs::path&) { return true; };
+
+    // A loop back to the root and a link to a file
+    fs::create_directory_symlink(testDataPath, testDataPath / "folder1/loop");
+    fs::create_symlink(testDataPath / "folder2/subfile1.txt", testDataPath / "link.txt");
+
+    ScanOptions options;
+    options.recursive = true;
+
+    FileEntryContainer followFiles;
+    scanner.scan(testDataPath, followFiles, all, options);
+    BOOST_TEST(followFiles.size() == 5);
+
+    options.symlinkPolicy = SymlinkPolicy::Ignore;
+    FileEntryContainer ignore;
+    scanner.scan(testDataPath, ignore, all, options);
+    BOOST_TEST(ignore.size() == 4);
+
+    // The loop is detected instead of being followed until the path is too long
+    options.symlinkPolicy = SymlinkPolicy::FollowAll;
+    FileEntryContainer followAll;
+    BOOST_TEST(scanner.scan(testDataPath, followAll, all, options));
+    BOOST_TEST(followAll.size() == 5);
+}
+
+BOOST_FIXTURE_TEST_CASE(FollowAllWithMaxDepth, TestFixture) {
+    FileScanner& scanner = FileScanner::getInstance();
+    auto all = [](const fs::path&) { return true; };
+
+    // x/target is too deep to be descended, link_x -> x/target is not
+    const auto root = testDataPath / "depth";
+    for (const std::string name : {"a", "b", "c", "d"}) {
+        fs::create_directories(root / name / "target");
+        std::ofstream(root / name / "target/f.txt") << name;
+        fs::create_directory_symlink(root / name / "target", root / ("link_" + name));
+    }
+
+    ScanOptions options;
+    options.recursive = true;
+    options.maxDepth = 1;
+    options.symlinkPolicy = SymlinkPolicy::FollowAll;
+
+    FileEntryContainer entries;
+    BOOST_TEST(scanner.scan(root, entries, all, options));
+    BOOST_TEST(entries.size() == 4);
+}
+
+BOOST_FIXTURE_TEST_CASE(ScanWithThrottling, TestFixture) {
+    FileScanner& scanner = FileScanner::getInstance();
+
+    ScanOptions options;
+    options.recursive = true;
+    options.maxEntriesPerSecond = 1000;
+    options.idlePriority = true;
+
+    FileEntryContainer entries;
+    BOOST_TEST(scanner.scan(testDataPath, entries, FileFilter::ext(".txt"), options));
+    BOOST_TEST(entries.size() == 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(ScanContainerWithRegex, TestFixture) {
+    FileScanner& scanner = FileScanner::getInstance();
+    FileEntryContainer entries;
+
+    scanner.scan(testDataPath, entries, std::vector<std::string>{R"(.*\.log$)"}, true);
+
+    entries.sortFileEntriesAlphabetically();
+    BOOST_TEST(entries.size() == 2);
+    BOOST_TEST(entries[0]->getPath().filename().string() == "file2.log");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,53 @@
+#define BOOST_TEST_MODULE IoThrottleTest
+#include <boost/test/included/unit_test.hpp>
+#include "IoThrottle.h"
+#include <chrono>
+
+BOOST_AUTO_TEST_SUITE(IoThrottleSuite)
+
+BOOST_AUTO_TEST_CASE(UnlimitedDoesNotWait) {
+    RateLimiter limiter;
+    BOOST_TEST(!limiter.isLimited());
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100000; ++i) {
+        limiter.acquire();
+    }
+    BOOST_TEST((std::chrono::steady_clock::now() - start < std::chrono::seconds(1)));
+}
+
+BOOST_AUTO_TEST_CASE(LimitedPacesCallers) {
+    // 1000 tokens per second with a burst of 1: 100 tokens take at least ~99ms
+    RateLimiter limiter(1000, 1);
+    BOOST_TEST(limiter.isLimited());
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        limiter.acquire();
+    }
+    BOOST_TEST((std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(90)));
+}
+
+BOOST_AUTO_TEST_CASE(LargeRequestsGoIntoDebt) {
+    RateLimiter limiter(10000, 10000);
+
+    // The first request drains the bucket, the second one waits for it to refill
+    const auto start = std::chrono::steady_clock::now();
+    limiter.acquire(10000);
+    limiter.acquire(1000);
+    BOOST_TEST((std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(90)));
+}
+
+BOOST_AUTO_TEST_CASE(IdlePriorityGuard) {
+    {
+        IoPriorityGuard inactive(false);
+        BOOST_TEST(!inactive.isActive());
+    }
+    // Lowering the own I/O priority is always permitted on Linux
+    IoPriorityGuard guard(true);
+#ifdef __linux__
+    BOOST_TEST(guard.isActive());
+#endif
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,166 @@
+#define BOOST_TEST_MODULE ScanResultFileTest
+#include <boost/test/included/unit_test.hpp>
+#include "ScanResultFile.h"
+#include "FileScanner.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Fixture for setting up and tearing down test resources
+struct TestFixture {
+    TestFixture() {
+        rootPath = fs::temp_directory_path() / "scan_result_file_test";
+        fs::remove_all(rootPath);
+        fs::create_directories(rootPath / "tree/folder1");
+        fs::create_directories(rootPath / "tree/folder2/nested");
+
+        std::ofstream(rootPath / "tree/folder1/file1.txt") << "File 1 content";
+        std::ofstream(rootPath / "tree/folder1/file2.log") << std::string(4096, 'x');
+        std::ofstream(rootPath / "tree/folder2/nested/subfile1.txt") << "Subfile 1 content";
+        fs::permissions(rootPath / "tree/folder1/file1.txt", fs::perms::owner_read | fs::perms::owner_write);
+    }
+
+    ~TestFixture() {
+        fs::remove_all(rootPath);
+    }
+
+    // Synthetic metadata for entry i
+    static FileMetadata metadataFor(size_t i) {
+        FileMetadata metadata;
+        metadata.size = i * 1000;
+        metadata.modificationTime = fs::file_time_type(fs::file_time_type::duration(1700000000000000000 + i));
+        metadata.permissions = (i % 2) ? fs::perms::owner_all : fs::perms::owner_read;
+        metadata.type = fs::file_type::regular;
+        return metadata;
+    }
+
+    static fs::path pathFor(size_t i) {
+        return "/data/project/dir" + std::to_string(i / 100) + "/file" + std::to_string(i) + ".dat";
+    }
+
+    fs::path rootPath;
+};
+
+BOOST_FIXTURE_TEST_SUITE(ScanResultFileSuite, TestFixture)
+
+BOOST_AUTO_TEST_CASE(RoundTripThroughStream) {
+    ScanResultOptions options;
+    options.entriesPerChunk = 100;   // Several chunks, the last one partial
+
+    std::stringstream stream;
+    ScanResultWriter writer(stream, options);
+    for (size_t i = 0; i < 1234; ++i) {
+        writer.append(pathFor(i), metadataFor(i));
+    }
+    writer.finish();
+    BOOST_TEST(writer.size() == 1234);
+
+    const auto reader = ScanResultReader::read(stream);
+    BOOST_TEST(reader.size() == 1234);
+    BOOST_TEST(reader.hasChecksums());
+
+    size_t i = 0;
+    BOOST_TEST(reader.foreach([&i](const ScanRecord& record) {
+        const auto expected = metadataFor(i);
+        BOOST_TEST(record.path == pathFor(i).string());
+        BOOST_TEST(record.size == expected.size);
+        BOOST_TEST((record.modificationTime == expected.modificationTime));
+        BOOST_TEST((record.permissions == expected.permissions));
+        BOOST_TEST((record.type == fs::file_type::regular));
+        ++i;
+        return true;
+    }));
+    BOOST_TEST(i == 1234);
+
+    // Random access decodes from the nearest restart point
+    std::string buffer;
+    for (size_t index : {0, 15, 16, 99, 100, 777, 1233}) {
+        BOOST_TEST(reader.at(index, buffer).path == pathFor(index).string());
+        BOOST_TEST(reader.at(index, buffer).size == metadataFor(index).size);
+    }
+    BOOST_CHECK_THROW(static_cast<void>(reader.at(1234, buffer)), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(ScanIntoFile) {
+    const auto resultPath = rootPath / "scan.fsilscan";
+    {
+        ScanResultWriter writer(resultPath);
+        ScanOptions options;
+        options.recursive = true;
+        BOOST_TEST(FileScanner::getInstance().scan(rootPath / "tree", writer, {".*\\.txt"}, options));
+        // Nothing is visible until the result is finished
+        BOOST_TEST(!fs::exists(resultPath));
+        writer.finish();
+    }
+
+    const auto reader = ScanResultReader::load(resultPath);
+    BOOST_TEST(reader.size() == 2);
+    reader.foreach([](const ScanRecord& record) {
+        const FileEntry entry{fs::path(record.path)};
+        BOOST_TEST(record.size == entry.getSize());
+        BOOST_TEST((record.modificationTime == entry.getModificationTime()));
+        BOOST_TEST((record.permissions == entry.getPermissions()));
+        return true;
+    });
+
+    const auto container = reader.toContainer();
+    BOOST_TEST(container.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(ContainerExport) {
+    FileEntryContainer entries;
+    FileScanner::getInstance().scan(rootPath / "tree", entries, [](const fs::path&) { return true; }, true);
+    entries.append(rootPath / "tree/missing.txt");
+
+    const auto resultPath = rootPath / "container.fsilscan";
+    ScanResultWriter writer(resultPath, ScanResultOptions{16, false});
+    BOOST_TEST(writer.append(entries) == 3);
+    writer.finish();
+    BOOST_CHECK_THROW(writer.append(rootPath / "tree/folder1/file1.txt"), std::runtime_error);
+
+    const auto reader = ScanResultReader::load(resultPath);
+    BOOST_TEST(reader.size() == 3);
+    BOOST_TEST(!reader.hasChecksums());
+}
+
+BOOST_AUTO_TEST_CASE(RejectsDamagedResults) {
+    std::stringstream stream;
+    {
+        ScanResultWriter writer(stream);
+        for (size_t i = 0; i < 100; ++i) {
+            writer.append(pathFor(i), metadataFor(i));
+        }
+        writer.finish();
+    }
+    const auto bytes = stream.str();
+
+    auto readBytes = [](const std::string& data, bool verify = true) {
+        std::istringstream in(data);
+        return ScanResultReader::read(in, verify);
+    };
+
+    BOOST_CHECK_NO_THROW(readBytes(bytes));
+    BOOST_CHECK_THROW(readBytes("not a scan result at all, not even close"), std::runtime_error);
+    // No trailer
+    BOOST_CHECK_THROW(readBytes(bytes.substr(0, bytes.size() - 30)), std::runtime_error);
+
+    // A flipped bit in the size column is caught by the checksum
+    auto damaged = bytes;
+    damaged[16 + 32 + 8] ^= 0x01;
+    BOOST_CHECK_THROW(readBytes(damaged), std::runtime_error);
+    BOOST_CHECK_NO_THROW(readBytes(damaged, false));
+
+    // An unfinished file result is discarded
+    const auto resultPath = rootPath / "unfinished.fsilscan";
+    {
+        ScanResultWriter writer(resultPath);
+        writer.append(pathFor(0), metadataFor(0));
+    }
+    BOOST_TEST(!fs::exists(resultPath));
+    BOOST_TEST(!fs::exists(rootPath / "unfinished.fsilscan.fsiltmp"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
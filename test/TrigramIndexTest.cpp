@@ -0,0 +1,177 @@
+#define BOOST_TEST_MODULE TrigramIndexTest
+#include <boost/test/included/unit_test.hpp>
+#include "TrigramIndex.h"
+#include "FileScanner.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+// Fixture for setting up and tearing down test resources
+struct TestFixture {
+    TestFixture() {
+        rootPath = fs::temp_directory_path() / "trigram_index_test";
+        fs::remove_all(rootPath);
+        fs::create_directories(rootPath / "src");
+
+        std::ofstream(rootPath / "src/alpha.cpp") << "int computeChecksum(int value) { return value * 31; }\n";
+        std::ofstream(rootPath / "src/beta.cpp") << "void renderFrame() { drawTriangle(); }\n";
+        std::ofstream(rootPath / "src/gamma.h") << "// computeChecksum is declared elsewhere\nstruct Frame;\n";
+        std::ofstream(rootPath / "notes.txt") << "Shopping list: apples, pears\n";
+
+        FileScanner::getInstance().scan(rootPath, entries, [](const fs::path&) { return true; }, true);
+    }
+
+    ~TestFixture() {
+        fs::remove_all(rootPath);
+    }
+
+    // Sorted file names, for order-independent comparisons
+    static std::vector<std::string> names(const std::vector<fs::path>& paths) {
+        std::vector<std::string> result;
+        for (const auto& path : paths) {
+            result.push_back(path.filename().string());
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    fs::path rootPath;
+    FileEntryContainer entries;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TrigramIndexSuite, TestFixture)
+
+BOOST_AUTO_TEST_CASE(LiteralCandidatesAndSearch) {
+    const auto index = TrigramIndex::build(entries);
+    BOOST_TEST(index.fileCount() == 4);
+    BOOST_TEST(index.trigramCount() > 0);
+
+    const std::vector<std::string> checksum = {"alpha.cpp", "gamma.h"};
+    BOOST_TEST(names(index.candidates("computeChecksum")) == checksum);
+    BOOST_TEST(names(index.search("computeChecksum")) == checksum);
+
+    const std::vector<std::string> frame = {"beta.cpp", "gamma.h"};
+    BOOST_TEST(names(index.candidates("Frame")) == frame);
+    BOOST_TEST(names(index.search("renderFrame")) == std::vector<std::string>{"beta.cpp"});
+
+    BOOST_TEST(index.candidates("nowhere to be found").empty());
+    // Too short to narrow anything down
+    BOOST_TEST(index.candidates("in").size() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(RegexSearch) {
+    const auto index = TrigramIndex::build(entries);
+
+    BOOST_TEST(names(index.regexCandidates("compute\\w+\\(int")) == std::vector<std::string>{"alpha.cpp"});
+    BOOST_TEST(names(index.searchRegex("draw[A-Z][a-z]+\\(")) == std::vector<std::string>{"beta.cpp"});
+
+    // Alternation and case folding cannot be narrowed, but still give the right answer
+    BOOST_TEST(index.regexCandidates("apples|drawTriangle").size() == 4);
+    BOOST_TEST(names(index.searchRegex("apples|drawTriangle")) == (std::vector<std::string>{"beta.cpp", "notes.txt"}));
+    BOOST_TEST(names(index.searchRegex("SHOPPING", std::regex_constants::icase)) ==
+               std::vector<std::string>{"notes.txt"});
+}
+
+BOOST_AUTO_TEST_CASE(RequiredLiterals) {
+    BOOST_TEST(TrigramIndex::requiredLiterals("hello") == std::vector<std::string>{"hello"});
+    BOOST_TEST(TrigramIndex::requiredLiterals("foo.*bar") == (std::vector<std::string>{"foo", "bar"}));
+    BOOST_TEST(TrigramIndex::requiredLiterals("colou?r") == (std::vector<std::string>{"colo", "r"}));
+    BOOST_TEST(TrigramIndex::requiredLiterals("ab+c") == (std::vector<std::string>{"ab", "c"}));
+    BOOST_TEST(TrigramIndex::requiredLiterals("file\\.txt$") == std::vector<std::string>{"file.txt"});
+    BOOST_TEST(TrigramIndex::requiredLiterals("x[)|]y(a|b)zzz") == (std::vector<std::string>{"x", "y", "zzz"}));
+    BOOST_TEST(TrigramIndex::requiredLiterals("one|two").empty());
+
+    // Escapes with operands consume them and end the run
+    BOOST_TEST(TrigramIndex::requiredLiterals("\\x41bcd") == std::vector<std::string>{"bcd"});
+    BOOST_TEST(TrigramIndex::requiredLiterals("\\u0041bcd") == std::vector<std::string>{"bcd"});
+    BOOST_TEST(TrigramIndex::requiredLiterals("\\cJabc") == std::vector<std::string>{"abc"});
+    BOOST_TEST(TrigramIndex::requiredLiterals("\\0abc") == std::vector<std::string>{"abc"});
+    BOOST_TEST(TrigramIndex::requiredLiterals("(a)\\12xyz") == std::vector<std::string>{"xyz"});
+}
+
+BOOST_AUTO_TEST_CASE(RegexEscapesAndGrammars) {
+    const auto index = TrigramIndex::build(entries);
+
+    // \x53 is 'S'
+    BOOST_TEST(names(index.searchRegex("\\x53hopping")) == std::vector<std::string>{"notes.txt"});
+    BOOST_TEST(names(index.searchRegex("\\u0053hopping")) == std::vector<std::string>{"notes.txt"});
+
+    // POSIX grammars are not narrowed: \{ \} are operators in basic, a newline separates alternatives in grep
+    const std::vector<std::string> notes = {"notes.txt"};
+    BOOST_TEST(index.regexCandidates("S\\{0,1\\}hopping", std::regex_constants::basic).size() == 4);
+    BOOST_TEST(names(index.searchRegex("S\\{0,1\\}hopping", std::regex_constants::basic)) == notes);
+    BOOST_TEST(names(index.searchRegex("Sh+opping", std::regex_constants::extended)) == notes);
+    BOOST_TEST(names(index.searchRegex("nowhere\napples", std::regex_constants::grep)) == notes);
+    BOOST_TEST(names(index.searchRegex("nowhere\napples", std::regex_constants::egrep)) == notes);
+}
+
+BOOST_AUTO_TEST_CASE(SaveAndLoad) {
+    const auto indexPath = rootPath / "index.fsiltri";
+    TrigramIndex::build(entries).save(indexPath);
+
+    const auto loaded = TrigramIndex::load(indexPath);
+    BOOST_TEST(loaded.fileCount() == 4);
+    BOOST_TEST(names(loaded.search("computeChecksum")) == (std::vector<std::string>{"alpha.cpp", "gamma.h"}));
+
+    std::ofstream(rootPath / "garbage.bin") << "definitely not an index";
+    BOOST_CHECK_THROW(TrigramIndex::load(rootPath / "garbage.bin"), std::runtime_error);
+    BOOST_CHECK_THROW(TrigramIndex::load(rootPath / "missing.bin"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(IncrementalUpdate) {
+    const auto index = TrigramIndex::build(entries);
+
+    // A changed size is picked up
+    std::ofstream(rootPath / "notes.txt") << "Shopping list: apples, pears, computeChecksum\n";
+    // Same size and modification time: treated as unchanged, so the old trigrams are kept
+    const auto betaPath = rootPath / "src/beta.cpp";
+    const auto modified = fs::last_write_time(betaPath);
+    std::ofstream(betaPath) << "void renderFrame() { drawPentagon(); }\n";
+    fs::last_write_time(betaPath, modified);
+
+    const auto updated = index.update(entries);
+    BOOST_TEST(updated.fileCount() == 4);
+    BOOST_TEST(names(updated.candidates("computeChecksum")) ==
+               (std::vector<std::string>{"alpha.cpp", "gamma.h", "notes.txt"}));
+    BOOST_TEST(names(updated.candidates("drawTriangle")) == std::vector<std::string>{"beta.cpp"});
+    BOOST_TEST(updated.candidates("drawPentagon").empty());
+
+    // Files that disappeared are dropped
+    fs::remove(rootPath / "src/gamma.h");
+    BOOST_TEST(updated.update(entries).fileCount() == 3);
+}
+
+BOOST_AUTO_TEST_CASE(LargeFilesAreAlwaysCandidates) {
+    TrigramIndexOptions options;
+    options.maxFileSize = 50;
+    const auto index = TrigramIndex::build(entries, options);
+
+    // alpha.cpp and gamma.h are larger than 50 bytes and were not read
+    BOOST_TEST(names(index.candidates("Shopping")) == (std::vector<std::string>{"alpha.cpp", "gamma.h", "notes.txt"}));
+    BOOST_TEST(names(index.search("drawTriangle")) == std::vector<std::string>{"beta.cpp"});
+}
+
+BOOST_AUTO_TEST_CASE(SearchStreamsLargeFiles) {
+    // Larger than maxFileSize, so always a candidate, and confirmed 64 KB at a time
+    std::string content(200 * 1024, 'a');
+    content.replace(64 * 1024 - 3, 6, "needle");
+    content.replace(128 * 1024 - 1, 9, "\nhaystack");
+    std::ofstream(rootPath / "large.log") << content;
+    entries.append(rootPath / "large.log");
+
+    TrigramIndexOptions options;
+    options.maxFileSize = 1024;
+    const auto index = TrigramIndex::build(entries, options);
+
+    const std::vector<std::string> large = {"large.log"};
+    BOOST_TEST(names(index.search("aaaneedleaaa")) == large);
+    BOOST_TEST(names(index.search("needle\n")).empty());
+    // Lines are matched one at a time: ^ matches at the start of every line
+    BOOST_TEST(names(index.searchRegex("^haystack")) == large);
+    BOOST_TEST(names(index.searchRegex("a\nhaystack")).empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()